@@ -20,21 +20,430 @@
 #ifndef BIG_INT_HPP
 #define BIG_INT_HPP
 
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
 #include <iostream>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+/*
+    LimbPool
+    --------
+    A per-thread cache of freed limb blocks, which the limb containers of the
+    multiplication and division kernels draw their buffers from. Blocks are
+    rounded up to a power-of-two size class, and each class is a LIFO stack, so
+    the buffers of a recursion level are handed straight to the next one while
+    they are still in cache, and threads never contend for the allocator.
+    NOTE: Blocks larger than MAX_BLOCK limbs, and blocks beyond DEPTH per class,
+    go directly to and from the heap, which bounds the memory each thread keeps.
+*/
+
+class LimbPool {
+    static const size_t MIN_BLOCK = 4;
+    static const size_t CLASSES = 13;   // blocks of 4, 8, ..., 2^14 limbs
+    static const size_t MAX_BLOCK = MIN_BLOCK << (CLASSES - 1);
+    static const size_t DEPTH = 8;
+
+    // trivially destructible, so that it stays usable while static objects
+    // holding limbs are destroyed after the thread's cleanup has run
+    struct Cache {
+        uint64_t* blocks[CLASSES][DEPTH];
+        size_t counts[CLASSES];
+        bool registered;
+        bool closed;
+    };
+
+    struct Cleanup {
+        ~Cleanup() {
+            Cache& cache = local_cache();
+            cache.closed = true;
+            for (size_t c = 0; c < CLASSES; c++)
+                while (cache.counts[c] > 0)
+                    delete[] cache.blocks[c][--cache.counts[c]];
+        }
+    };
+
+    static Cache& local_cache() {
+        static thread_local Cache cache;
+        return cache;
+    }
+
+    // the smallest size class holding `capacity` limbs
+    static size_t size_class(size_t capacity) {
+        if (capacity <= MIN_BLOCK)
+            return 0;
+        return 64 - __builtin_clzll(capacity - 1) - 2;
+    }
+
+    public:
+        // returns a block of at least `capacity` limbs, setting `capacity` to
+        // its actual size
+        static uint64_t* allocate(size_t& capacity) {
+            if (capacity > MAX_BLOCK)
+                return new uint64_t[capacity];
+
+            size_t c = size_class(capacity);
+            capacity = MIN_BLOCK << c;
+            Cache& cache = local_cache();
+            if (cache.counts[c] > 0)
+                return cache.blocks[c][--cache.counts[c]];
+            return new uint64_t[capacity];
+        }
+
+        // gives back a block of `capacity` limbs obtained from allocate
+        static void release(uint64_t* block, size_t capacity) {
+            if (capacity <= MAX_BLOCK) {
+                Cache& cache = local_cache();
+                size_t c = size_class(capacity);
+                if (!cache.closed and cache.counts[c] < DEPTH) {
+                    if (!cache.registered) {
+                        cache.registered = true;
+                        static thread_local Cleanup cleanup;
+                        (void) cleanup;
+                    }
+                    cache.blocks[c][cache.counts[c]++] = block;
+                    return;
+                }
+            }
+            delete[] block;
+        }
+};
+
+
+/*
+    LimbVector
+    ----------
+    A vector of limbs that keeps up to SMALL_LIMBS limbs inside the object
+    itself, and only moves them to a LimbPool block once it outgrows them. Single- and
+    double-word values, which are most of the temporaries in typical use (small
+    integers, differences of coordinates, quotient digits), therefore never
+    allocate.
+    NOTE: Only the parts of the std::vector interface used on limbs are
+    provided, and iterators are plain pointers.
+*/
+
+class LimbVector {
+    static const size_t SMALL_LIMBS = 2;
+
+    uint64_t* storage;      // either small_limbs or a LimbPool block
+    size_t length;
+    size_t allocated;
+    uint64_t small_limbs[SMALL_LIMBS];
+
+    bool is_small() const {
+        return storage == small_limbs;
+    }
+
+    void release() {
+        if (!is_small())
+            LimbPool::release(storage, allocated);
+        storage = small_limbs;
+        allocated = SMALL_LIMBS;
+    }
+
+    // grows the capacity to at least `capacity` limbs, keeping the contents
+    void grow(size_t capacity) {
+        capacity = std::max(capacity, 2 * allocated);
+        uint64_t* block = LimbPool::allocate(capacity);
+        std::copy(storage, storage + length, block);
+        release();
+        storage = block;
+        allocated = capacity;
+    }
+
+    public:
+        typedef uint64_t value_type;
+        typedef uint64_t* iterator;
+        typedef const uint64_t* const_iterator;
+
+        LimbVector() : storage(small_limbs), length(0), allocated(SMALL_LIMBS) {}
+
+        explicit LimbVector(size_t count, uint64_t value = 0) : LimbVector() {
+            assign(count, value);
+        }
+
+        LimbVector(const uint64_t* first, const uint64_t* last) : LimbVector() {
+            assign(first, last);
+        }
+
+        LimbVector(std::initializer_list<uint64_t> values) : LimbVector() {
+            assign(values.begin(), values.end());
+        }
+
+        LimbVector(const LimbVector& other) : LimbVector() {
+            assign(other.begin(), other.end());
+        }
+
+        LimbVector(LimbVector&& other) noexcept : LimbVector() {
+            *this = std::move(other);
+        }
+
+        ~LimbVector() {
+            release();
+        }
+
+        LimbVector& operator=(const LimbVector& other) {
+            if (this != &other)
+                assign(other.begin(), other.end());
+            return *this;
+        }
+
+        LimbVector& operator=(LimbVector&& other) noexcept {
+            if (this == &other)
+                return *this;
+            if (other.is_small()) {     // small limbs cannot be stolen
+                release();
+                std::copy(other.storage, other.storage + other.length, small_limbs);
+            }
+            else {
+                release();
+                storage = other.storage;
+                allocated = other.allocated;
+                other.storage = other.small_limbs;
+                other.allocated = SMALL_LIMBS;
+            }
+            length = other.length;
+            other.length = 0;
+            return *this;
+        }
+
+        size_t size() const { return length; }
+        bool empty() const { return length == 0; }
+
+        uint64_t& operator[](size_t i) { return storage[i]; }
+        const uint64_t& operator[](size_t i) const { return storage[i]; }
+        uint64_t& back() { return storage[length - 1]; }
+        const uint64_t& back() const { return storage[length - 1]; }
+        uint64_t* data() { return storage; }
+        const uint64_t* data() const { return storage; }
+
+        iterator begin() { return storage; }
+        iterator end() { return storage + length; }
+        const_iterator begin() const { return storage; }
+        const_iterator end() const { return storage + length; }
+
+        void reserve(size_t capacity) {
+            if (capacity > allocated)
+                grow(capacity);
+        }
+
+        void resize(size_t count, uint64_t value = 0) {
+            reserve(count);
+            if (count > length)
+                std::fill(storage + length, storage + count, value);
+            length = count;
+        }
+
+        void clear() {
+            length = 0;
+        }
+
+        void assign(size_t count, uint64_t value) {
+            length = 0;
+            resize(count, value);
+        }
+
+        void assign(const uint64_t* first, const uint64_t* last) {
+            size_t count = last - first;
+            if (count > allocated) {
+                release();
+                allocated = count;
+                storage = LimbPool::allocate(allocated);
+            }
+            std::copy(first, last, storage);
+            length = count;
+        }
+
+        void push_back(uint64_t value) {
+            if (length == allocated)
+                grow(length + 1);
+            storage[length++] = value;
+        }
+
+        void pop_back() {
+            length--;
+        }
+
+        iterator insert(const_iterator position, size_t count, uint64_t value) {
+            size_t offset = position - storage;
+            reserve(length + count);
+            std::copy_backward(storage + offset, storage + length,
+                               storage + length + count);
+            std::fill(storage + offset, storage + offset + count, value);
+            length += count;
+            return storage + offset;
+        }
+
+        iterator insert(const_iterator position, uint64_t value) {
+            return insert(position, 1, value);
+        }
+
+        iterator erase(const_iterator first, const_iterator last) {
+            size_t offset = first - storage, count = last - first;
+            std::copy(storage + offset + count, storage + length, storage + offset);
+            length -= count;
+            return storage + offset;
+        }
+
+        iterator erase(const_iterator position) {
+            return erase(position, position + 1);
+        }
+
+        friend bool operator==(const LimbVector& num1, const LimbVector& num2) {
+            return std::equal(num1.begin(), num1.end(), num2.begin(), num2.end());
+        }
+
+        friend bool operator!=(const LimbVector& num1, const LimbVector& num2) {
+            return !(num1 == num2);
+        }
+};
+
+
+/*
+    OperationCounters
+    -----------------
+    Counts of the BigInt multiplications and divisions done through the public
+    operators, with the total limbs of their operands, for profiling. Each
+    thread only ever adds to its own counters, so counting an operation costs a
+    few plain additions; totals() sums the counters over all threads, including
+    the ones that have already exited.
+    NOTE: The counters only exist when BIG_INT_OPERATION_COUNTERS is defined;
+    otherwise BIG_INT_COUNT expands to nothing. The solver's --profile reports
+    them from a build such as
+        g++ -std=c++17 -O2 -pthread -DBIG_INT_OPERATION_COUNTERS -o solver solver.cpp
+*/
+
+#ifdef BIG_INT_OPERATION_COUNTERS
+
+#include <atomic>
+#include <mutex>
+
+class OperationCounters {
+    public:
+        enum Operation {
+            MULTIPLY,       // BigInt by BigInt (or a square)
+            DIVIDE,         // BigInt by BigInt, giving a quotient, a remainder or both
+            WORD_MULTIPLY,  // BigInt by a machine integer
+            WORD_DIVIDE,    // BigInt by a machine integer
+            OPERATIONS
+        };
+
+        struct Totals {
+            uint64_t count[OPERATIONS] = {};
+            uint64_t first_limbs[OPERATIONS] = {};      // of the LHS operands
+            uint64_t second_limbs[OPERATIONS] = {};     // of the RHS operands
+        };
+
+        static void record(Operation operation, size_t first_limbs,
+                size_t second_limbs) {
+            Counters& counters = local_counters();
+            increment(counters.count[operation], 1);
+            increment(counters.first_limbs[operation], first_limbs);
+            increment(counters.second_limbs[operation], second_limbs);
+        }
+
+        static Totals totals() {
+            Registry& registry = get_registry();
+            std::lock_guard<std::mutex> lock(registry.mutex);
+            Totals totals = registry.retired;
+            for (const Counters* counters : registry.live)
+                counters->add_to(totals);
+
+            return totals;
+        }
+
+    private:
+        // only the owning thread writes, so a relaxed load and store suffice
+        static void increment(std::atomic<uint64_t>& counter, uint64_t amount) {
+            counter.store(counter.load(std::memory_order_relaxed) + amount,
+                          std::memory_order_relaxed);
+        }
+
+        struct Counters {
+            std::atomic<uint64_t> count[OPERATIONS];
+            std::atomic<uint64_t> first_limbs[OPERATIONS];
+            std::atomic<uint64_t> second_limbs[OPERATIONS];
+
+            Counters() {
+                for (size_t i = 0; i < OPERATIONS; i++) {
+                    count[i] = 0;
+                    first_limbs[i] = 0;
+                    second_limbs[i] = 0;
+                }
+                Registry& registry = get_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                registry.live.push_back(this);
+            }
+
+            ~Counters() {
+                Registry& registry = get_registry();
+                std::lock_guard<std::mutex> lock(registry.mutex);
+                add_to(registry.retired);
+                registry.live.erase(std::find(registry.live.begin(),
+                                              registry.live.end(), this));
+            }
+
+            void add_to(Totals& totals) const {
+                for (size_t i = 0; i < OPERATIONS; i++) {
+                    totals.count[i] += count[i].load(std::memory_order_relaxed);
+                    totals.first_limbs[i] += first_limbs[i].load(std::memory_order_relaxed);
+                    totals.second_limbs[i] += second_limbs[i].load(std::memory_order_relaxed);
+                }
+            }
+        };
+
+        struct Registry {
+            std::mutex mutex;
+            std::vector<const Counters*> live;
+            Totals retired;     // the counts of the threads that have exited
+        };
+
+        static Registry& get_registry() {
+            static Registry registry;
+            return registry;
+        }
+
+        static Counters& local_counters() {
+            static thread_local Counters counters;
+            return counters;
+        }
+};
+
+#define BIG_INT_COUNT(operation, first_limbs, second_limbs) \
+    OperationCounters::record(OperationCounters::operation, first_limbs, second_limbs)
+
+#else
+
+#define BIG_INT_COUNT(operation, first_limbs, second_limbs)
+
+#endif  // BIG_INT_OPERATION_COUNTERS
+
 
 class BigInt {
-    std::string value;
+    LimbVector limbs;   // magnitude in base 2^64, least significant limb
+                        // first, without leading zero limbs
     char sign;
 
+    void add_signed_magnitude(const LimbVector&, char);
+    void add_signed_limb(uint64_t, char);
+    int compare_integer(long long) const;
+
     public:
         // Constructors:
         BigInt();
         BigInt(const BigInt&);
+        BigInt(BigInt&&) noexcept;
         BigInt(const long long&);
         BigInt(const std::string&);
 
         // Assignment operators:
         BigInt& operator=(const BigInt&);
+        BigInt& operator=(BigInt&&) noexcept;
         BigInt& operator=(const long long&);
         BigInt& operator=(const std::string&);
 
@@ -102,18 +511,41 @@ class BigInt {
         bool operator==(const std::string&) const;
         bool operator!=(const std::string&) const;
 
+        // Allocation-free predicates:
+        bool is_zero() const;
+        bool is_one() const;
+        bool fits_int64() const;
+        int compare_magnitude(const BigInt&) const;
+
         // I/O stream operators:
         friend std::istream& operator>>(std::istream&, BigInt&);
         friend std::ostream& operator<<(std::ostream&, const BigInt&);
 
         // Conversion functions:
-        std::string to_string() const;
+        std::string to_string(int = 10) const;
         int to_int() const;
         long to_long() const;
         long long to_long_long() const;
+        static BigInt from_string(std::string_view, int);
+        std::vector<uint64_t> to_limbs() const;
+        static BigInt from_limbs(const void*, size_t, bool = false);
+
+        // Squaring:
+        BigInt square() const;
+        friend BigInt sqrt(const BigInt&);
 
         // Random number generating functions:
         friend BigInt big_random(size_t);
+
+        // Division with remainder:
+        friend std::tuple<BigInt, BigInt> divmod(const BigInt&, const BigInt&);
+
+        // Greatest common divisors:
+        friend BigInt gcd(const BigInt&, const BigInt&);
+        friend std::tuple<BigInt, BigInt, BigInt> ext_gcd(const BigInt&, const BigInt&);
+
+        // Modular arithmetic:
+        friend class Montgomery;
 };
 
 #endif  // BIG_INT_HPP
@@ -128,8 +560,38 @@ class BigInt {
 #ifndef BIG_INT_UTILITY_FUNCTIONS_HPP
 #define BIG_INT_UTILITY_FUNCTIONS_HPP
 
+#include <algorithm>
+#include <atomic>
+#include <deque>
+#include <mutex>
 #include <tuple>
 
+// carry chains and comparisons of limb arrays use x86-64 intrinsics where the
+// compiler provides them, and portable 128-bit arithmetic elsewhere
+#if defined(__x86_64__) and (defined(__GNUC__) or defined(__clang__))
+#define BIG_INT_X86_64_KERNELS
+#include <immintrin.h>
+#endif
+
+
+// double-width unsigned integer used for limb products and carries
+typedef unsigned __int128 uint128_t;
+
+// the number of limbs in the smaller operand from which multiplication
+// switches from the schoolbook method to Karatsuba's algorithm, then to
+// Toom-3, then to NTT convolution
+const size_t KARATSUBA_THRESHOLD = 48;
+const size_t TOOM3_THRESHOLD = 250;
+const size_t NTT_THRESHOLD = 12000;
+
+// schoolbook squaring only computes half of the limb products, so it stays
+// faster than Karatsuba squaring for longer
+const size_t KARATSUBA_SQUARE_THRESHOLD = 80;
+
+// divisors with fewer limbs than this are divided using Algorithm D instead of
+// Burnikel-Ziegler division
+const size_t BURNIKEL_ZIEGLER_THRESHOLD = 80;
+
 
 /*
     is_valid_number
@@ -149,86 +611,1183 @@ bool is_valid_number(const std::string& num) {
 /*
     strip_leading_zeroes
     --------------------
-    Strip the leading zeroes from a number represented as a string.
+    Strip the leading zero limbs from a number represented as limbs.
+*/
+
+void strip_leading_zeroes(LimbVector& num) {
+    while (!num.empty() and num.back() == 0)
+        num.pop_back();
+}
+
+
+/*
+    unsigned_abs
+    ------------
+    Returns the magnitude of an integer as a limb, without overflowing for
+    LLONG_MIN.
+*/
+
+uint64_t unsigned_abs(long long num) {
+    return num < 0 ? 0 - (uint64_t) num : (uint64_t) num;
+}
+
+
+/*
+    bit_length
+    ----------
+    Returns the number of significant bits in a number represented as limbs.
+*/
+
+size_t bit_length(const LimbVector& num) {
+    if (num.empty())
+        return 0;
+
+    return 64 * num.size() - __builtin_clzll(num.back());
+}
+
+
+/*
+    add_limbs_n
+    -----------
+    Adds the `n`-limb arrays `num1` and `num2` and the carry `carry` into
+    `sum`, returning the carry out. `sum` may be the same array as either
+    operand.
+    NOTE: On x86-64 the carry stays in the carry flag, through a chain of adc
+    instructions.
+*/
+
+uint64_t add_limbs_n(uint64_t* sum, const uint64_t* num1, const uint64_t* num2,
+        size_t n, uint64_t carry = 0) {
+#ifdef BIG_INT_X86_64_KERNELS
+    unsigned char carry_flag = (unsigned char) carry;
+    unsigned long long limb;
+    for (size_t i = 0; i < n; i++) {
+        carry_flag = _addcarry_u64(carry_flag, num1[i], num2[i], &limb);
+        sum[i] = limb;
+    }
+    return carry_flag;
+#else
+    for (size_t i = 0; i < n; i++) {
+        uint128_t limb_sum = (uint128_t) num1[i] + num2[i] + carry;
+        sum[i] = (uint64_t) limb_sum;
+        carry = (uint64_t) (limb_sum >> 64);
+    }
+    return carry;
+#endif
+}
+
+
+/*
+    add_carry_n
+    -----------
+    Adds the carry `carry` to the `n`-limb array `num` and stores the result in
+    `sum`, returning the carry out. `sum` may be the same array as `num`.
 */
 
-void strip_leading_zeroes(std::string& num) {
+uint64_t add_carry_n(uint64_t* sum, const uint64_t* num, size_t n,
+        uint64_t carry) {
     size_t i;
-    for (i = 0; i < num.size(); i++)
-        if (num[i] != '0')
+    for (i = 0; i < n and carry; i++) {
+        sum[i] = num[i] + carry;
+        carry = sum[i] < carry;
+    }
+    if (sum != num)
+        std::copy(num + i, num + n, sum + i);
+
+    return carry;
+}
+
+
+/*
+    subtract_limbs_n
+    ----------------
+    Subtracts the `n`-limb array `num2` and the borrow `borrow` from `num1`
+    into `difference`, returning the borrow out. `difference` may be the same
+    array as either operand.
+    NOTE: On x86-64 the borrow stays in the carry flag, through a chain of sbb
+    instructions.
+*/
+
+uint64_t subtract_limbs_n(uint64_t* difference, const uint64_t* num1,
+        const uint64_t* num2, size_t n, uint64_t borrow = 0) {
+#ifdef BIG_INT_X86_64_KERNELS
+    unsigned char borrow_flag = (unsigned char) borrow;
+    unsigned long long limb;
+    for (size_t i = 0; i < n; i++) {
+        borrow_flag = _subborrow_u64(borrow_flag, num1[i], num2[i], &limb);
+        difference[i] = limb;
+    }
+    return borrow_flag;
+#else
+    for (size_t i = 0; i < n; i++) {
+        uint128_t limb_difference = (uint128_t) num1[i] - num2[i] - borrow;
+        difference[i] = (uint64_t) limb_difference;
+        borrow = (uint64_t) (limb_difference >> 64) & 1;
+    }
+    return borrow;
+#endif
+}
+
+
+/*
+    subtract_borrow_n
+    -----------------
+    Subtracts the borrow `borrow` from the `n`-limb array `num` and stores the
+    result in `difference`, returning the borrow out. `difference` may be the
+    same array as `num`.
+*/
+
+uint64_t subtract_borrow_n(uint64_t* difference, const uint64_t* num, size_t n,
+        uint64_t borrow) {
+    size_t i;
+    for (i = 0; i < n and borrow; i++) {
+        uint64_t limb = num[i];
+        difference[i] = limb - borrow;
+        borrow = limb < borrow;
+    }
+    if (difference != num)
+        std::copy(num + i, num + n, difference + i);
+
+    return borrow;
+}
+
+
+/*
+    compare_limbs_n
+    ---------------
+    Compares two `n`-limb arrays, returning -1, 0 or 1 if `num1` is less than,
+    equal to or greater than `num2`.
+    NOTE: Long equal prefixes are skipped four limbs at a time with AVX2 when
+    the CPU supports it, which is checked once at run time.
+*/
+
+#ifdef BIG_INT_X86_64_KERNELS
+__attribute__((target("avx2")))
+size_t skip_equal_limbs_avx2(const uint64_t* num1, const uint64_t* num2,
+        size_t n) {
+    while (n >= 4) {
+        __m256i limbs1 = _mm256_loadu_si256((const __m256i*) (num1 + n - 4));
+        __m256i limbs2 = _mm256_loadu_si256((const __m256i*) (num2 + n - 4));
+        if (_mm256_movemask_epi8(_mm256_cmpeq_epi64(limbs1, limbs2)) != -1)
             break;
+        n -= 4;
+    }
+    return n;
+}
+#endif
+
+int compare_limbs_n(const uint64_t* num1, const uint64_t* num2, size_t n) {
+#ifdef BIG_INT_X86_64_KERNELS
+    static const bool has_avx2 = (__builtin_cpu_init(),
+                                  __builtin_cpu_supports("avx2"));
+    if (n >= 8 and has_avx2 and num1[n - 1] == num2[n - 1])
+        n = skip_equal_limbs_avx2(num1, num2, n);
+#endif
+    for (size_t i = n; i-- > 0; )
+        if (num1[i] != num2[i])
+            return num1[i] < num2[i] ? -1 : 1;
+
+    return 0;
+}
 
-    if (i == num.size())
-        num = "0";
-    else
-        num = num.substr(i);
+
+/*
+    compare_limbs
+    -------------
+    Compares two numbers represented as limbs, returning a negative value, zero
+    or a positive value if `num1` is less than, equal to or greater than `num2`.
+*/
+
+int compare_limbs(const LimbVector& num1,
+        const LimbVector& num2) {
+    if (num1.size() != num2.size())
+        return num1.size() < num2.size() ? -1 : 1;
+
+    return compare_limbs_n(num1.data(), num2.data(), num1.size());
+}
+
+
+/*
+    add_limbs
+    ---------
+    Returns the sum of two numbers represented as limbs.
+*/
+
+LimbVector add_limbs(const LimbVector& num1,
+        const LimbVector& num2) {
+    const LimbVector& larger = num1.size() >= num2.size() ? num1 : num2;
+    const LimbVector& smaller = num1.size() >= num2.size() ? num2 : num1;
+
+    LimbVector sum(larger.size() + 1);
+    size_t n = smaller.size();
+    uint64_t carry = add_limbs_n(sum.data(), larger.data(), smaller.data(), n);
+    carry = add_carry_n(sum.data() + n, larger.data() + n, larger.size() - n,
+                        carry);
+    sum[larger.size()] = carry;
+    strip_leading_zeroes(sum);
+
+    return sum;
+}
+
+
+/*
+    add_limbs_shifted
+    -----------------
+    Adds `num`, shifted left by `shift` limbs, to `acc` in place.
+*/
+
+void add_limbs_shifted(LimbVector& acc,
+        const LimbVector& num, size_t shift) {
+    if (num.empty())
+        return;
+    if (acc.size() < num.size() + shift)
+        acc.resize(num.size() + shift, 0);
+
+    uint64_t* target = acc.data() + shift;
+    uint64_t carry = add_limbs_n(target, target, num.data(), num.size());
+    size_t high = shift + num.size();
+    carry = add_carry_n(acc.data() + high, acc.data() + high, acc.size() - high,
+                        carry);
+    if (carry)
+        acc.push_back(carry);
+}
+
+
+/*
+    subtract_limbs_in_place
+    -----------------------
+    Subtracts `num2` from `num1` in place.
+    NOTE: `num1` must not be smaller than `num2`.
+*/
+
+void subtract_limbs_in_place(LimbVector& num1,
+        const LimbVector& num2) {
+    size_t n = std::min(num1.size(), num2.size());
+    uint64_t borrow = subtract_limbs_n(num1.data(), num1.data(), num2.data(), n);
+    subtract_borrow_n(num1.data() + n, num1.data() + n, num1.size() - n, borrow);
+    strip_leading_zeroes(num1);
+}
+
+
+/*
+    subtract_limbs
+    --------------
+    Returns the difference of two numbers represented as limbs.
+    NOTE: `num1` must not be smaller than `num2`.
+*/
+
+LimbVector subtract_limbs(const LimbVector& num1,
+        const LimbVector& num2) {
+    LimbVector difference = num1;
+    subtract_limbs_in_place(difference, num2);
+
+    return difference;
 }
 
 
 /*
-    add_leading_zeroes
+    shift_limbs_left
+    ----------------
+    Returns a number represented as limbs shifted left by `shift` bits.
+*/
+
+LimbVector shift_limbs_left(const LimbVector& num,
+        size_t shift) {
+    if (num.empty())
+        return {};
+
+    size_t limb_shift = shift / 64, bit_shift = shift % 64;
+    LimbVector result(num.size() + limb_shift + 1, 0);
+    for (size_t i = 0; i < num.size(); i++) {
+        result[i + limb_shift] |= num[i] << bit_shift;
+        if (bit_shift)
+            result[i + limb_shift + 1] = num[i] >> (64 - bit_shift);
+    }
+    strip_leading_zeroes(result);
+
+    return result;
+}
+
+
+/*
+    shift_limbs_right
+    -----------------
+    Returns a number represented as limbs shifted right by `shift` bits.
+*/
+
+LimbVector shift_limbs_right(const LimbVector& num,
+        size_t shift) {
+    size_t limb_shift = shift / 64, bit_shift = shift % 64;
+    if (limb_shift >= num.size())
+        return {};
+
+    LimbVector result(num.size() - limb_shift);
+    for (size_t i = 0; i < result.size(); i++) {
+        result[i] = num[i + limb_shift] >> bit_shift;
+        if (bit_shift and i + limb_shift + 1 < num.size())
+            result[i] |= num[i + limb_shift + 1] << (64 - bit_shift);
+    }
+    strip_leading_zeroes(result);
+
+    return result;
+}
+
+
+/*
+    multiply_add_limb
+    -----------------
+    Replaces `num` with `num * multiplier + addend` in place.
+*/
+
+void multiply_add_limb(LimbVector& num, uint64_t multiplier,
+        uint64_t addend) {
+    uint64_t carry = addend;
+    for (uint64_t& limb : num) {
+        uint128_t product = (uint128_t) limb * multiplier + carry;
+        limb = (uint64_t) product;
+        carry = (uint64_t) (product >> 64);
+    }
+    if (carry)
+        num.push_back(carry);
+    strip_leading_zeroes(num);
+}
+
+
+/*
+    divide_limb
+    -----------
+    Divides a number represented as limbs by a single non-zero limb in place,
+    returning the remainder.
+*/
+
+uint64_t divide_limb(LimbVector& num, uint64_t divisor) {
+    uint128_t remainder = 0;
+    for (size_t i = num.size(); i-- > 0; ) {
+        uint128_t current = (remainder << 64) | num[i];
+        num[i] = (uint64_t) (current / divisor);
+        remainder = current % divisor;
+    }
+    strip_leading_zeroes(num);
+
+    return (uint64_t) remainder;
+}
+
+
+/*
+    remainder_limb
+    --------------
+    Returns the remainder on dividing a number represented as limbs by a single
+    non-zero limb.
+*/
+
+uint64_t remainder_limb(const LimbVector& num, uint64_t divisor) {
+    uint128_t remainder = 0;
+    for (size_t i = num.size(); i-- > 0; )
+        remainder = ((remainder << 64) | num[i]) % divisor;
+
+    return (uint64_t) remainder;
+}
+
+
+/*
+    multiply_limbs_schoolbook
+    -------------------------
+    Returns the product of two numbers represented as limbs using the schoolbook
+    method.
+*/
+
+LimbVector multiply_limbs_schoolbook(const LimbVector& num1,
+        const LimbVector& num2) {
+    if (num1.empty() or num2.empty())
+        return {};
+
+    LimbVector product(num1.size() + num2.size(), 0);
+    for (size_t i = 0; i < num1.size(); i++) {
+        uint64_t carry = 0;
+        for (size_t j = 0; j < num2.size(); j++) {
+            uint128_t limb_product = (uint128_t) num1[i] * num2[j]
+                                     + product[i + j] + carry;
+            product[i + j] = (uint64_t) limb_product;
+            carry = (uint64_t) (limb_product >> 64);
+        }
+        product[i + num2.size()] = carry;
+    }
+    strip_leading_zeroes(product);
+
+    return product;
+}
+
+
+/*
+    split_limbs
+    -----------
+    Splits a number represented as limbs into its `high` and `low` parts, where
+    `low` holds the first `low_length` limbs.
+*/
+
+std::tuple<LimbVector, LimbVector> split_limbs(
+        const LimbVector& num, size_t low_length) {
+    if (num.size() <= low_length)
+        return std::make_tuple(LimbVector(), num);
+
+    LimbVector high(num.begin() + low_length, num.end());
+    LimbVector low(num.begin(), num.begin() + low_length);
+    strip_leading_zeroes(low);
+
+    return std::make_tuple(std::move(high), std::move(low));
+}
+
+
+LimbVector multiply_limbs(const LimbVector&,
+        const LimbVector&);
+LimbVector square_limbs(const LimbVector&);
+
+
+/*
+    square_limbs_schoolbook
+    -----------------------
+    Returns the square of a number represented as limbs using the schoolbook
+    method, computing each cross product a[i] * a[j] (i < j) only once.
+*/
+
+LimbVector square_limbs_schoolbook(const LimbVector& num) {
+    if (num.empty())
+        return {};
+
+    // the cross products, which each appear twice in the square
+    size_t n = num.size();
+    LimbVector square(2 * n, 0);
+    for (size_t i = 0; i < n; i++) {
+        uint64_t carry = 0;
+        for (size_t j = i + 1; j < n; j++) {
+            uint128_t limb_product = (uint128_t) num[i] * num[j] + square[i + j] + carry;
+            square[i + j] = (uint64_t) limb_product;
+            carry = (uint64_t) (limb_product >> 64);
+        }
+        square[i + n] = carry;
+    }
+
+    // double them, then add the squares of the limbs on the diagonal
+    uint64_t carry = 0;
+    for (uint64_t& limb : square) {
+        uint64_t next_carry = limb >> 63;
+        limb = (limb << 1) | carry;
+        carry = next_carry;
+    }
+    carry = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint128_t limb_square = (uint128_t) num[i] * num[i];
+        uint128_t limb_sum = (uint128_t) square[2 * i] + (uint64_t) limb_square + carry;
+        square[2 * i] = (uint64_t) limb_sum;
+        limb_sum = (limb_sum >> 64) + square[2 * i + 1] + (uint64_t) (limb_square >> 64);
+        square[2 * i + 1] = (uint64_t) limb_sum;
+        carry = (uint64_t) (limb_sum >> 64);
+    }
+    strip_leading_zeroes(square);
+
+    return square;
+}
+
+
+/*
+    square_limbs_karatsuba
+    ----------------------
+    Returns the square of a number represented as limbs using Karatsuba's
+    algorithm, which needs three half-size squares.
+*/
+
+LimbVector square_limbs_karatsuba(const LimbVector& num) {
+    size_t half_length = num.size() / 2;
+
+    LimbVector num_high, num_low;
+    std::tie(num_high, num_low) = split_limbs(num, half_length);
+
+    LimbVector square_high, square_mid, square_low;
+    square_high = square_limbs(num_high);
+    square_low = square_limbs(num_low);
+    square_mid = square_limbs(add_limbs(num_high, num_low));
+    subtract_limbs_in_place(square_mid, square_high);
+    subtract_limbs_in_place(square_mid, square_low);
+
+    LimbVector square = square_low;
+    add_limbs_shifted(square, square_mid, half_length);
+    add_limbs_shifted(square, square_high, 2 * half_length);
+
+    return square;
+}
+
+
+/*
+    multiply_limbs_karatsuba
+    ------------------------
+    Returns the product of two numbers represented as limbs using Karatsuba's
+    algorithm.
+*/
+
+LimbVector multiply_limbs_karatsuba(const LimbVector& num1,
+        const LimbVector& num2) {
+    size_t half_length = std::max(num1.size(), num2.size()) / 2;
+
+    LimbVector num1_high, num1_low;
+    std::tie(num1_high, num1_low) = split_limbs(num1, half_length);
+
+    LimbVector num2_high, num2_low;
+    std::tie(num2_high, num2_low) = split_limbs(num2, half_length);
+
+    LimbVector prod_high, prod_mid, prod_low;
+    prod_high = multiply_limbs(num1_high, num2_high);
+    prod_low = multiply_limbs(num1_low, num2_low);
+    prod_mid = multiply_limbs(add_limbs(num1_high, num1_low),
+                              add_limbs(num2_high, num2_low));
+    subtract_limbs_in_place(prod_mid, prod_high);
+    subtract_limbs_in_place(prod_mid, prod_low);
+
+    LimbVector product = prod_low;
+    add_limbs_shifted(product, prod_mid, half_length);
+    add_limbs_shifted(product, prod_high, 2 * half_length);
+
+    return product;
+}
+
+
+// a signed number represented as limbs, for the intermediate values of
+// Toom-Cook multiplication, which can be negative
+struct SignedLimbs {
+    LimbVector magnitude;
+    bool negative = false;
+};
+
+
+/*
+    add_signed_limbs
+    ----------------
+    Returns the sum of two signed numbers represented as limbs, negating the
+    second one first if `subtract` is set.
+*/
+
+SignedLimbs add_signed_limbs(const SignedLimbs& num1, const SignedLimbs& num2,
+        bool subtract = false) {
+    bool num2_negative = num2.negative != subtract;
+
+    SignedLimbs sum;
+    if (num1.negative == num2_negative) {
+        sum.magnitude = add_limbs(num1.magnitude, num2.magnitude);
+        sum.negative = num1.negative;
+    }
+    else if (compare_limbs(num1.magnitude, num2.magnitude) >= 0) {
+        sum.magnitude = subtract_limbs(num1.magnitude, num2.magnitude);
+        sum.negative = num1.negative;
+    }
+    else {
+        sum.magnitude = subtract_limbs(num2.magnitude, num1.magnitude);
+        sum.negative = num2_negative;
+    }
+    if (sum.magnitude.empty())
+        sum.negative = false;
+
+    return sum;
+}
+
+
+/*
+    multiply_signed_limbs
+    ---------------------
+    Returns the product of two signed numbers represented as limbs.
+*/
+
+SignedLimbs multiply_signed_limbs(const SignedLimbs& num1, const SignedLimbs& num2) {
+    SignedLimbs product;
+    product.magnitude = multiply_limbs(num1.magnitude, num2.magnitude);
+    product.negative = !product.magnitude.empty() and num1.negative != num2.negative;
+
+    return product;
+}
+
+
+/*
+    toom3_evaluate
+    --------------
+    Helper function for Toom-3 multiplication that splits a number into three
+    `part_length`-limb parts, the coefficients of a quadratic, and evaluates it
+    at 0, 1, -1, -2 and infinity.
+*/
+
+std::vector<SignedLimbs> toom3_evaluate(const LimbVector& num,
+        size_t part_length) {
+    LimbVector high, low;
+    SignedLimbs part0, part1, part2;
+    std::tie(high, part0.magnitude) = split_limbs(num, part_length);
+    std::tie(part2.magnitude, part1.magnitude) = split_limbs(high, part_length);
+
+    SignedLimbs outer = add_signed_limbs(part0, part2);
+    SignedLimbs at_1 = add_signed_limbs(outer, part1);
+    SignedLimbs at_minus_1 = add_signed_limbs(outer, part1, true);
+
+    // p(-2) = 2 (p(-1) + part2) - part0
+    SignedLimbs at_minus_2 = add_signed_limbs(at_minus_1, part2);
+    at_minus_2.magnitude = shift_limbs_left(at_minus_2.magnitude, 1);
+    at_minus_2 = add_signed_limbs(at_minus_2, part0, true);
+
+    return {part0, at_1, at_minus_1, at_minus_2, part2};
+}
+
+
+/*
+    multiply_limbs_toom3
+    --------------------
+    Returns the product of two numbers represented as limbs using the Toom-Cook
+    3-way algorithm, with Bodrato's interpolation sequence. When both operands
+    are the same object, it is evaluated once and its values are squared.
+*/
+
+LimbVector multiply_limbs_toom3(const LimbVector& num1,
+        const LimbVector& num2) {
+    size_t part_length = (std::max(num1.size(), num2.size()) + 2) / 3;
+    bool squaring = &num1 == &num2;
+
+    std::vector<SignedLimbs> values1 = toom3_evaluate(num1, part_length);
+    std::vector<SignedLimbs> values2;
+    if (!squaring)
+        values2 = toom3_evaluate(num2, part_length);
+
+    // the product's values at 0, 1, -1, -2 and infinity
+    std::vector<SignedLimbs> values(5);
+    for (size_t i = 0; i < 5; i++)
+        values[i] = multiply_signed_limbs(values1[i], squaring ? values1[i] : values2[i]);
+
+    SignedLimbs coeff0 = values[0], coeff4 = values[4];
+
+    SignedLimbs coeff3 = add_signed_limbs(values[3], values[1], true);
+    divide_limb(coeff3.magnitude, 3);   // exact
+
+    SignedLimbs coeff1 = add_signed_limbs(values[1], values[2], true);
+    coeff1.magnitude = shift_limbs_right(coeff1.magnitude, 1);  // exact
+
+    SignedLimbs coeff2 = add_signed_limbs(values[2], values[0], true);
+
+    coeff3 = add_signed_limbs(coeff2, coeff3, true);
+    coeff3.magnitude = shift_limbs_right(coeff3.magnitude, 1);  // exact
+    SignedLimbs double_coeff4 = coeff4;
+    double_coeff4.magnitude = shift_limbs_left(coeff4.magnitude, 1);
+    coeff3 = add_signed_limbs(coeff3, double_coeff4);
+
+    coeff2 = add_signed_limbs(add_signed_limbs(coeff2, coeff1), coeff4, true);
+    coeff1 = add_signed_limbs(coeff1, coeff3, true);
+
+    // the coefficients of the product are all non-negative
+    LimbVector product = coeff0.magnitude;
+    add_limbs_shifted(product, coeff1.magnitude, part_length);
+    add_limbs_shifted(product, coeff2.magnitude, 2 * part_length);
+    add_limbs_shifted(product, coeff3.magnitude, 3 * part_length);
+    add_limbs_shifted(product, coeff4.magnitude, 4 * part_length);
+
+    return product;
+}
+
+
+/*
+    NttPrime
+    --------
+    An NTT-friendly prime below 2^62 (2^32 divides p - 1), with arithmetic on
+    residues in Montgomery form.
+*/
+
+struct NttPrime {
+    uint64_t modulus;
+    uint64_t modulus_inverse;   // -modulus^(-1) mod 2^64
+    uint64_t r_squared;         // 2^128 mod modulus
+    uint64_t generator;         // a primitive root, in Montgomery form
+
+    NttPrime(uint64_t prime, uint64_t primitive_root) {
+        modulus = prime;
+        uint64_t inverse = prime;
+        for (int i = 0; i < 5; i++)
+            inverse *= 2 - prime * inverse;
+        modulus_inverse = 0 - inverse;
+        uint64_t r = (uint64_t) (((uint128_t) 1 << 64) % prime);
+        r_squared = (uint64_t) ((uint128_t) r * r % prime);
+        generator = to_montgomery(primitive_root);
+    }
+
+    uint64_t reduce(uint128_t num) const {
+        uint64_t m = (uint64_t) num * modulus_inverse;
+        uint64_t result = (uint64_t) ((num + (uint128_t) m * modulus) >> 64);
+        return result >= modulus ? result - modulus : result;
+    }
+    uint64_t multiply(uint64_t num1, uint64_t num2) const {
+        return reduce((uint128_t) num1 * num2);
+    }
+    uint64_t add(uint64_t num1, uint64_t num2) const {
+        uint64_t sum = num1 + num2;
+        return sum >= modulus ? sum - modulus : sum;
+    }
+    uint64_t subtract(uint64_t num1, uint64_t num2) const {
+        return num1 >= num2 ? num1 - num2 : num1 + modulus - num2;
+    }
+    uint64_t power(uint64_t base, uint64_t exp) const {
+        uint64_t result = to_montgomery(1);
+        for (; exp; exp /= 2, base = multiply(base, base))
+            if (exp % 2)
+                result = multiply(result, base);
+        return result;
+    }
+    uint64_t to_montgomery(uint64_t num) const {
+        return multiply(num % modulus, r_squared);
+    }
+    uint64_t from_montgomery(uint64_t num) const {
+        return reduce(num);
+    }
+};
+
+
+/*
+    ntt
+    ---
+    Transforms a power-of-two length sequence of residues in place with the
+    iterative number-theoretic transform, or its inverse.
+*/
+
+void ntt(LimbVector& values, bool inverse, const NttPrime& prime) {
+    size_t n = values.size();
+    for (size_t i = 1, j = 0; i < n; i++) {     // bit-reversal permutation
+        size_t bit = n >> 1;
+        for (; j & bit; bit >>= 1)
+            j ^= bit;
+        j ^= bit;
+        if (i < j)
+            std::swap(values[i], values[j]);
+    }
+
+    LimbVector roots;
+    for (size_t length = 2; length <= n; length *= 2) {
+        uint64_t root = prime.power(prime.generator, (prime.modulus - 1) / length);
+        if (inverse)
+            root = prime.power(root, prime.modulus - 2);
+        roots.assign(1, prime.to_montgomery(1));
+        for (size_t i = 1; i < length / 2; i++)
+            roots.push_back(prime.multiply(roots.back(), root));
+
+        for (size_t i = 0; i < n; i += length)
+            for (size_t j = 0; j < length / 2; j++) {
+                uint64_t even = values[i + j];
+                uint64_t odd = prime.multiply(values[i + j + length / 2], roots[j]);
+                values[i + j] = prime.add(even, odd);
+                values[i + j + length / 2] = prime.subtract(even, odd);
+            }
+    }
+
+    if (inverse) {
+        uint64_t n_inverse = prime.power(prime.to_montgomery(n), prime.modulus - 2);
+        for (uint64_t& value : values)
+            value = prime.multiply(value, n_inverse);
+    }
+}
+
+
+/*
+    multiply_limbs_ntt
     ------------------
-    Adds a given number of leading zeroes to a string-represented integer `num`.
+    Returns the product of two numbers represented as limbs by convolving their
+    limbs with number-theoretic transforms over three primes, and recovering
+    each (up to 186-bit) coefficient with the Chinese remainder theorem. When
+    both operands are the same object, only one forward transform is needed.
 */
 
-void add_leading_zeroes(std::string& num, size_t num_zeroes) {
-    num = std::string(num_zeroes, '0') + num;
-}
+LimbVector multiply_limbs_ntt(const LimbVector& num1,
+        const LimbVector& num2) {
+    static const NttPrime primes[3] = {
+        NttPrime(4611685941117976577ULL, 3),
+        NttPrime(4611685692009873409ULL, 19),
+        NttPrime(4611685606110527489ULL, 3)
+    };
+
+    size_t length = 1;
+    while (length < num1.size() + num2.size())
+        length *= 2;
+
+    LimbVector residues[3];
+    for (int k = 0; k < 3; k++) {
+        const NttPrime& prime = primes[k];
+        LimbVector values1(length, 0), values2;
+        for (size_t i = 0; i < num1.size(); i++)
+            values1[i] = prime.to_montgomery(num1[i]);
+        ntt(values1, false, prime);
+
+        if (&num1 == &num2)
+            values2 = values1;
+        else {
+            values2.assign(length, 0);
+            for (size_t i = 0; i < num2.size(); i++)
+                values2[i] = prime.to_montgomery(num2[i]);
+            ntt(values2, false, prime);
+        }
+        for (size_t i = 0; i < length; i++)
+            values1[i] = prime.multiply(values1[i], values2[i]);
+        ntt(values1, true, prime);
+
+        for (uint64_t& value : values1)
+            value = prime.from_montgomery(value);
+        residues[k] = std::move(values1);
+    }
+
+    // Garner's algorithm: coefficient = x0 + p0 x1 + p0 p1 x2
+    uint64_t p0 = primes[0].modulus, p1 = primes[1].modulus, p2 = primes[2].modulus;
+    auto inverse_mod = [](uint64_t num, uint64_t prime) {
+        uint64_t result = 1;
+        for (uint64_t exp = prime - 2; exp; exp /= 2, num = (uint128_t) num * num % prime)
+            if (exp % 2)
+                result = (uint128_t) result * num % prime;
+        return result;
+    };
+    uint64_t p0_inverse_mod_p1 = inverse_mod(p0 % p1, p1);
+    uint64_t p0p1_inverse_mod_p2 = inverse_mod((uint128_t) p0 * p1 % p2, p2);
+    uint128_t p0p1 = (uint128_t) p0 * p1;
+
+    LimbVector product(num1.size() + num2.size(), 0);
+    uint64_t carry[3] = {0, 0, 0};  // the running sum of coefficients, shifted down
+    for (size_t i = 0; i < product.size(); i++) {
+        uint64_t x0 = residues[0][i];
+        uint64_t x1 = (uint128_t) ((residues[1][i] + p1 - x0 % p1) % p1)
+                      * p0_inverse_mod_p1 % p1;
+        uint128_t partial = x0 + (uint128_t) p0 * x1;
+        uint64_t x2 = (uint128_t) ((residues[2][i] + p2 - (uint64_t) (partial % p2)) % p2)
+                      * p0p1_inverse_mod_p2 % p2;
+
+        // carry += partial + p0p1 * x2, in 192-bit arithmetic
+        uint128_t low_product = (uint128_t) (uint64_t) p0p1 * x2;
+        uint128_t high_product = (uint128_t) (uint64_t) (p0p1 >> 64) * x2;
+        uint128_t sum = (uint128_t) carry[0] + (uint64_t) partial + (uint64_t) low_product;
+        carry[0] = (uint64_t) sum;
+        sum = (sum >> 64) + carry[1] + (uint64_t) (partial >> 64)
+              + (uint64_t) (low_product >> 64) + (uint64_t) high_product;
+        carry[1] = (uint64_t) sum;
+        carry[2] += (uint64_t) (sum >> 64) + (uint64_t) (high_product >> 64);
+
+        product[i] = carry[0];
+        carry[0] = carry[1];
+        carry[1] = carry[2];
+        carry[2] = 0;
+    }
+    strip_leading_zeroes(product);
+
+    return product;
+}
+
+
+/*
+    multiply_limbs_unbalanced
+    -------------------------
+    Returns the product of two numbers represented as limbs of very different
+    lengths, by multiplying the smaller one with chunks of the larger one that
+    are as long as the smaller one.
+*/
+
+LimbVector multiply_limbs_unbalanced(const LimbVector& larger,
+        const LimbVector& smaller) {
+    LimbVector product;
+    for (size_t i = 0; i < larger.size(); i += smaller.size()) {
+        LimbVector chunk(larger.begin() + i,
+            larger.begin() + std::min(i + smaller.size(), larger.size()));
+        strip_leading_zeroes(chunk);
+        add_limbs_shifted(product, multiply_limbs(chunk, smaller), i);
+    }
+
+    return product;
+}
+
+
+/*
+    multiply_limbs
+    --------------
+    Returns the product of two numbers represented as limbs, using the
+    schoolbook method, Karatsuba's algorithm, Toom-3 or NTT convolution
+    depending on the size of the smaller operand. Operands of very different
+    lengths are first split into balanced products.
+*/
+
+LimbVector multiply_limbs(const LimbVector& num1,
+        const LimbVector& num2) {
+    if (&num1 == &num2)
+        return square_limbs(num1);
+
+    const LimbVector& larger = num1.size() >= num2.size() ? num1 : num2;
+    const LimbVector& smaller = num1.size() >= num2.size() ? num2 : num1;
+
+    if (larger.size() == 1 and smaller.size() == 1) {   // single-word product
+        uint128_t product = (uint128_t) larger[0] * smaller[0];
+        LimbVector result = {(uint64_t) product, (uint64_t) (product >> 64)};
+        strip_leading_zeroes(result);
+        return result;
+    }
+    if (smaller.size() < KARATSUBA_THRESHOLD)
+        return multiply_limbs_schoolbook(larger, smaller);
+    if (larger.size() >= 2 * smaller.size())
+        return multiply_limbs_unbalanced(larger, smaller);
+    if (smaller.size() >= NTT_THRESHOLD)
+        return multiply_limbs_ntt(larger, smaller);
+    if (smaller.size() >= TOOM3_THRESHOLD)
+        return multiply_limbs_toom3(larger, smaller);
+
+    return multiply_limbs_karatsuba(larger, smaller);
+}
+
+
+/*
+    square_limbs
+    ------------
+    Returns the square of a number represented as limbs, using the squaring
+    variant of the multiplication algorithm for its size.
+*/
+
+LimbVector square_limbs(const LimbVector& num) {
+    if (num.size() < KARATSUBA_SQUARE_THRESHOLD)
+        return square_limbs_schoolbook(num);
+    if (num.size() >= NTT_THRESHOLD)
+        return multiply_limbs_ntt(num, num);
+    if (num.size() >= TOOM3_THRESHOLD)
+        return multiply_limbs_toom3(num, num);
+
+    return square_limbs_karatsuba(num);
+}
+
+
+/*
+    digit_value
+    -----------
+    Returns the value of a digit in bases up to 36, where the digits beyond 9
+    are the letters a-z in either case, or -1 if the character is not a digit.
+*/
+
+int digit_value(char digit) {
+    if (digit >= '0' and digit <= '9')
+        return digit - '0';
+    if (digit >= 'a' and digit <= 'z')
+        return digit - 'a' + 10;
+    if (digit >= 'A' and digit <= 'Z')
+        return digit - 'A' + 10;
+
+    return -1;
+}
+
+
+/*
+    radix_chunk_length
+    ------------------
+    Returns the largest number of digits in the given base whose value always
+    fits in a limb.
+*/
+
+size_t radix_chunk_length(int base) {
+    size_t chunk_length = 0;
+    for (uint64_t chunk_base = 1; chunk_base <= UINT64_MAX / base; chunk_base *= base)
+        chunk_length++;
+
+    return chunk_length;
+}
+
+
+// digit strings with more chunks, and numbers with more limbs, than this are
+// converted by splitting them in halves instead of chunk by chunk
+const size_t RADIX_DIVIDE_AND_CONQUER_THRESHOLD = 64;
+
+// the digits written in bases up to 36
+const char RADIX_DIGITS[] = "0123456789abcdefghijklmnopqrstuvwxyz";
+
+
+/*
+    parse_limbs_horner
+    ------------------
+    Converts a string of valid digits in the given base to limbs using Horner's
+    method, consuming one limb-sized chunk of digits per step.
+*/
+
+LimbVector parse_limbs_horner(std::string_view digits, int base,
+        size_t chunk_length) {
+    LimbVector num;
+
+    // the first chunk takes up the digits left over
+    size_t length = digits.size() % chunk_length;
+    if (length == 0)
+        length = chunk_length;
+    for (size_t i = 0; i < digits.size(); i += length, length = chunk_length) {
+        uint64_t chunk = 0, chunk_base = 1;
+        for (size_t j = i; j < i + length; j++) {
+            chunk = chunk * base + digit_value(digits[j]);
+            chunk_base *= base;
+        }
+        multiply_add_limb(num, chunk_base, chunk);
+    }
+
+    return num;
+}
+
+
+/*
+    radix_power
+    -----------
+    Returns base^(chunk_length * 2^level) for bases 2 to 36, where chunk_length
+    is radix_chunk_length(base). The powers come from a process-wide table that
+    is built by repeated squaring on first use and shared by the conversions in
+    both directions, so each power is computed once per program rather than
+    once per conversion.
+    NOTE: Each power is published through an atomic pointer once built, so
+    looking up an existing one takes no lock; only extending the table takes
+    the mutex. Entries never move, so the returned reference stays valid for
+    the rest of the program.
+*/
+
+// more levels than any number that fits in memory needs
+const size_t RADIX_POWER_LEVELS = 48;
+
+const LimbVector& radix_power(int base, size_t level) {
+    static std::atomic<const LimbVector*> published[37][RADIX_POWER_LEVELS];
+    static std::mutex table_mutex;
+    static std::deque<LimbVector> tables[37];
+
+    const LimbVector* power = published[base][level].load(std::memory_order_acquire);
+    if (power != nullptr)
+        return *power;
+
+    std::lock_guard<std::mutex> lock(table_mutex);
+    std::deque<LimbVector>& powers = tables[base];
+    if (powers.empty()) {
+        uint64_t chunk_base = 1;
+        for (size_t i = radix_chunk_length(base); i > 0; i--)
+            chunk_base *= base;
+        powers.push_back({chunk_base});
+        published[base][0].store(&powers.back(), std::memory_order_release);
+    }
+    while (powers.size() <= level) {
+        powers.push_back(square_limbs(powers.back()));
+        published[base][powers.size() - 1].store(&powers.back(), std::memory_order_release);
+    }
+
+    return powers[level];
+}
+
+
+/*
+    parse_limbs
+    -----------
+    Converts a string of valid digits in the given base to limbs. Long strings
+    are split so that the low part holds `chunk_length * 2^level` digits and
+    the halves are combined as `high * radix_power(base, level) + low`.
+*/
+
+LimbVector parse_limbs(std::string_view digits, int base,
+        size_t chunk_length) {
+    size_t num_chunks = (digits.size() + chunk_length - 1) / chunk_length;
+    if (num_chunks <= RADIX_DIVIDE_AND_CONQUER_THRESHOLD)
+        return parse_limbs_horner(digits, base, chunk_length);
+
+    // the largest level whose power splits off fewer digits than there are
+    size_t level = 0;
+    while (chunk_length << (level + 1) < digits.size())
+        level++;
+    size_t low_length = chunk_length << level;
+
+    LimbVector num = multiply_limbs(
+        parse_limbs(digits.substr(0, digits.size() - low_length), base,
+                    chunk_length),
+        radix_power(base, level));
+    add_limbs_shifted(num, parse_limbs(digits.substr(digits.size() - low_length),
+                                       base, chunk_length), 0);
+
+    return num;
+}
+
+
+LimbVector parse_limbs(std::string_view digits, int base) {
+    return parse_limbs(digits, base, radix_chunk_length(base));
+}
+
+
+// defined with the division operators
+std::tuple<LimbVector, LimbVector> divide(
+        const LimbVector&, const LimbVector&);
 
 
 /*
-    add_trailing_zeroes
-    -------------------
-    Adds a given number of trailing zeroes to a string-represented integer `num`.
+    format_limbs_schoolbook
+    -----------------------
+    Appends the digits of the magnitude `num` in the given base to `out',
+    zero-padded on the left to `width` digits, by repeatedly dividing off a
+    limb-sized chunk of digits.
 */
 
-void add_trailing_zeroes(std::string& num, size_t num_zeroes) {
-    num += std::string(num_zeroes, '0');
+void format_limbs_schoolbook(std::string& out, const LimbVector& num,
+        int base, size_t width) {
+    size_t chunk_length = radix_chunk_length(base);
+    uint64_t chunk_base = radix_power(base, 0)[0];
+
+    // the digits come out least significant first
+    std::string reversed;
+    LimbVector quotient = num;
+    while (!quotient.empty()) {
+        uint64_t chunk = divide_limb(quotient, chunk_base);
+        for (size_t i = 0; i < chunk_length and (chunk or !quotient.empty()); i++) {
+            reversed += RADIX_DIGITS[chunk % base];
+            chunk /= base;
+        }
+    }
+    if (reversed.size() < width)
+        out.append(width - reversed.size(), '0');
+    out.append(reversed.rbegin(), reversed.rend());
 }
 
 
 /*
-    get_larger_and_smaller
-    ----------------------
-    Identifies the given string-represented integers as `larger` and `smaller`,
-    padding the smaller number with leading zeroes to make it equal in length to
-    the larger number.
+    format_limbs
+    ------------
+    Appends the digits of the magnitude `num` in the given base to `out',
+    zero-padded on the left to `width` digits (no digits at all for zero with
+    no width). Long numbers are split as `high * radix_power(base, level) +
+    low` with one division, and the halves are formatted recursively, the low
+    half padded to its full `chunk_length * 2^level` digits, so conversion
+    costs a few multiplications' worth instead of quadratic time.
 */
 
-std::tuple<std::string, std::string> get_larger_and_smaller(const std::string& num1,
-        const std::string& num2) {
-    std::string larger, smaller;
-    if (num1.size() > num2.size() or
-        (num1.size() == num2.size() and num1 > num2)) {
-        larger = num1;
-        smaller = num2;
-    }
-    else {
-        larger = num2;
-        smaller = num1;
+void format_limbs(std::string& out, const LimbVector& num, int base,
+        size_t width) {
+    if (num.size() <= RADIX_DIVIDE_AND_CONQUER_THRESHOLD) {
+        format_limbs_schoolbook(out, num, base, width);
+        return;
     }
 
-    // pad the smaller number with zeroes
-    add_leading_zeroes(smaller, larger.size() - smaller.size());
-
-    return std::make_tuple(larger, smaller);
+    // the first level whose power has more than a quarter of the limbs of
+    // `num` (each level doubles the size, so that is at most about half)
+    size_t level = 0;
+    while (radix_power(base, level).size() * 4 <= num.size())
+        level++;
+    size_t low_width = radix_chunk_length(base) << level;
+
+    LimbVector high, low;
+    std::tie(high, low) = divide(num, radix_power(base, level));
+    format_limbs(out, high, base, width > low_width ? width - low_width : 0);
+    format_limbs(out, low, base, low_width);
 }
 
 
 /*
-    is_power_of_10
-    ----------------------
-    Checks whether a string-represented integer is a power of 10.
+    format_limbs_power_of_two
+    -------------------------
+    Appends the digits of the non-zero magnitude `num` in base 2^`digit_bits`
+    (up to 32) to `out`. Each digit is a group of bits read straight out of the
+    limbs, so this takes linear time and no division at all.
 */
 
-bool is_power_of_10(const std::string& num){
-    if (num[0] != '1')
-        return false;
-    for (size_t i = 1; i < num.size(); i++)
-        if (num[i] != '0')
-            return false;
-
-    return true;    // first digit is 1 and the following digits are all 0
+void format_limbs_power_of_two(std::string& out, const LimbVector& num,
+        int digit_bits) {
+    uint64_t mask = (1ULL << digit_bits) - 1;
+    size_t num_digits = (bit_length(num) + digit_bits - 1) / digit_bits;
+    out.reserve(out.size() + num_digits);
+    for (size_t i = num_digits; i-- > 0; ) {
+        size_t shift = i * digit_bits, limb = shift / 64, bit = shift % 64;
+        uint64_t digit = num[limb] >> bit;
+        if (bit + digit_bits > 64 and limb + 1 < num.size())   // straddles two limbs
+            digit |= num[limb + 1] << (64 - bit);
+        out += RADIX_DIGITS[digit & mask];
+    }
 }
 
 #endif  // BIG_INT_UTILITY_FUNCTIONS_HPP
@@ -265,18 +1824,17 @@ BigInt big_random(size_t num_digits = 0) {
         // use a random number for it:
         num_digits = 1 + rand_generator() % MAX_RANDOM_LENGTH;
 
-    BigInt big_rand;
-    big_rand.value = "";    // clear value to append digits
+    std::string digits;
 
     // ensure that the first digit is non-zero
-    big_rand.value += std::to_string(1 + rand_generator() % 9);
+    digits += std::to_string(1 + rand_generator() % 9);
 
-    while (big_rand.value.size() < num_digits)
-        big_rand.value += std::to_string(rand_generator());
-    if (big_rand.value.size() != num_digits)
-        big_rand.value.erase(num_digits);   // erase extra digits
+    while (digits.size() < num_digits)
+        digits += std::to_string(rand_generator());
+    if (digits.size() != num_digits)
+        digits.erase(num_digits);   // erase extra digits
 
-    return big_rand;
+    return BigInt(digits);
 }
 
 
@@ -300,7 +1858,6 @@ BigInt big_random(size_t num_digits = 0) {
 */
 
 BigInt::BigInt() {
-    value = "0";
     sign = '+';
 }
 
@@ -311,7 +1868,18 @@ BigInt::BigInt() {
 */
 
 BigInt::BigInt(const BigInt& num) {
-    value = num.value;
+    limbs = num.limbs;
+    sign = num.sign;
+}
+
+
+/*
+    Move constructor
+    ----------------
+*/
+
+BigInt::BigInt(BigInt&& num) noexcept {
+    limbs = std::move(num.limbs);
     sign = num.sign;
 }
 
@@ -322,7 +1890,9 @@ BigInt::BigInt(const BigInt& num) {
 */
 
 BigInt::BigInt(const long long& num) {
-    value = std::to_string(std::abs(num));
+    uint64_t magnitude = unsigned_abs(num);
+    if (magnitude != 0)
+        limbs.push_back(magnitude);
     if (num < 0)
         sign = '-';
     else
@@ -336,26 +1906,22 @@ BigInt::BigInt(const long long& num) {
 */
 
 BigInt::BigInt(const std::string& num) {
+    std::string magnitude;
     if (num[0] == '+' or num[0] == '-') {     // check for sign
-        std::string magnitude = num.substr(1);
-        if (is_valid_number(magnitude)) {
-            value = magnitude;
-            sign = num[0];
-        }
-        else {
-            throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
-        }
+        magnitude = num.substr(1);
+        sign = num[0];
     }
     else {      // if no sign is specified
-        if (is_valid_number(num)) {
-            value = num;
-            sign = '+';    // positive by default
-        }
-        else {
-            throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
-        }
+        magnitude = num;
+        sign = '+';    // positive by default
     }
-    strip_leading_zeroes(value);
+    if (!is_valid_number(magnitude))
+        throw std::invalid_argument("Expected an integer, got \'" + num + "\'");
+
+    limbs = parse_limbs(magnitude, 10);
+
+    if (limbs.empty())  // zero is always positive
+        sign = '+';
 }
 
 #endif  // BIG_INT_CONSTRUCTORS_HPP
@@ -370,16 +1936,76 @@ BigInt::BigInt(const std::string& num) {
 #ifndef BIG_INT_CONVERSION_FUNCTIONS_HPP
 #define BIG_INT_CONVERSION_FUNCTIONS_HPP
 
+#include <cstring>
+#include <stdexcept>
+
 
 /*
     to_string
     ---------
-    Converts a BigInt to a string.
+    Converts a BigInt to a string of digits in the given base (2 to 36, by
+    default 10), where the digits beyond 9 are the lowercase letters a-z.
+    NOTE: Bases that are powers of two take linear time; other bases split the
+    number recursively by cached powers of the base (see format_limbs).
+    If the base is out of range, an invalid_argument exception is thrown.
 */
 
-std::string BigInt::to_string() const {
+std::string BigInt::to_string(int base) const {
+    if (base < 2 or base > 36)
+        throw std::invalid_argument("Expected a base from 2 to 36, got "
+                                    + std::to_string(base));
+    if (limbs.empty())
+        return "0";
+
     // prefix with sign if negative
-    return this->sign == '-' ? "-" + this->value : this->value;
+    std::string num = this->sign == '-' ? "-" : "";
+    if ((base & (base - 1)) == 0)
+        format_limbs_power_of_two(num, limbs, __builtin_ctz(base));
+    else
+        format_limbs(num, limbs, base, 0);
+
+    return num;
+}
+
+
+/*
+    from_string
+    -----------
+    Converts a string of digits in the given base (2 to 36) to a BigInt, where
+    the digits beyond 9 are the letters a-z in either case. The digits may be
+    preceded by a sign.
+    NOTE: If the base is out of range, or the string has no digits or contains
+    a digit that is invalid for the base, an invalid_argument exception is
+    thrown.
+*/
+
+BigInt BigInt::from_string(std::string_view num, int base) {
+    if (base < 2 or base > 36)
+        throw std::invalid_argument("Expected a base from 2 to 36, got "
+                                    + std::to_string(base));
+
+    BigInt result;
+    std::string_view digits = num;
+    if (!digits.empty() and (digits[0] == '+' or digits[0] == '-')) {
+        result.sign = digits[0];
+        digits.remove_prefix(1);
+    }
+    if (digits.empty())
+        throw std::invalid_argument("Expected a base " + std::to_string(base)
+                                    + " integer, got \'" + std::string(num) + "\'");
+    for (char digit : digits) {
+        int value = digit_value(digit);
+        if (value < 0 or value >= base)
+            throw std::invalid_argument("Invalid digit \'" + std::string(1, digit)
+                                        + "\' for base " + std::to_string(base)
+                                        + " in \'" + std::string(num) + "\'");
+    }
+
+    result.limbs = parse_limbs(digits, base);
+    if (result.limbs.empty())   // zero is always positive
+        result.sign = '+';
+
+    return result;
 }
 
 
@@ -387,12 +2013,16 @@ std::string BigInt::to_string() const {
     to_int
     ------
     Converts a BigInt to an int.
-    NOTE: If the BigInt is out of range of an int, stoi() will throw an
-    out_of_range exception.
+    NOTE: If the BigInt is out of range of an int, an out_of_range exception is
+    thrown.
 */
 
 int BigInt::to_int() const {
-    return std::stoi(this->to_string());
+    long long num = this->to_long_long();
+    if (num < INT_MIN or num > INT_MAX)
+        throw std::out_of_range("BigInt is out of range of an int");
+
+    return (int) num;
 }
 
 
@@ -400,12 +2030,16 @@ int BigInt::to_int() const {
     to_long
     -------
     Converts a BigInt to a long int.
-    NOTE: If the BigInt is out of range of a long int, stol() will throw an
-    out_of_range exception.
+    NOTE: If the BigInt is out of range of a long int, an out_of_range
+    exception is thrown.
 */
 
 long BigInt::to_long() const {
-    return std::stol(this->to_string());
+    long long num = this->to_long_long();
+    if (num < LONG_MIN or num > LONG_MAX)
+        throw std::out_of_range("BigInt is out of range of a long int");
+
+    return (long) num;
 }
 
 
@@ -413,12 +2047,63 @@ long BigInt::to_long() const {
     to_long_long
     ------------
     Converts a BigInt to a long long int.
-    NOTE: If the BigInt is out of range of a long long int, stoll() will throw
-    an out_of_range exception.
+    NOTE: If the BigInt is out of range of a long long int, an out_of_range
+    exception is thrown.
 */
 
 long long BigInt::to_long_long() const {
-    return std::stoll(this->to_string());
+    if (limbs.empty())
+        return 0;
+
+    uint64_t max_magnitude = (uint64_t) LLONG_MAX + (this->sign == '-');
+    if (limbs.size() > 1 or limbs[0] > max_magnitude)
+        throw std::out_of_range("BigInt is out of range of a long long int");
+
+    return this->sign == '-' ? (long long) (0 - limbs[0]) : (long long) limbs[0];
+}
+
+
+/*
+    to_limbs
+    --------
+    Returns the magnitude of a BigInt as 64-bit limbs, least significant first,
+    with no leading zero limbs (so zero has none).
+*/
+
+std::vector<uint64_t> BigInt::to_limbs() const {
+    return std::vector<uint64_t>(limbs.begin(), limbs.end());
+}
+
+
+/*
+    from_limbs
+    ----------
+    Constructs a BigInt from `count` 64-bit limbs stored little-endian at
+    `data`, least significant first, negated if `negative` is set.
+    NOTE: `data` need not be aligned; on little-endian hosts the limbs are
+    copied with a single memcpy.
+*/
+
+BigInt BigInt::from_limbs(const void* data, size_t count, bool negative) {
+    BigInt result;
+    result.limbs.resize(count);
+#if defined(__BYTE_ORDER__) and __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+    if (count > 0)
+        std::memcpy(result.limbs.data(), data, count * sizeof(uint64_t));
+#else
+    const unsigned char* bytes = static_cast<const unsigned char*>(data);
+    for (size_t i = 0; i < count; i++) {
+        uint64_t limb = 0;
+        for (int b = 7; b >= 0; b--)
+            limb = limb << 8 | bytes[i * 8 + b];
+        result.limbs[i] = limb;
+    }
+#endif
+    strip_leading_zeroes(result.limbs);
+    if (negative and !result.limbs.empty())
+        result.sign = '-';
+
+    return result;
 }
 
 #endif  // BIG_INT_CONVERSION_FUNCTIONS_HPP
@@ -441,7 +2126,20 @@ long long BigInt::to_long_long() const {
 */
 
 BigInt& BigInt::operator=(const BigInt& num) {
-    value = num.value;
+    limbs = num.limbs;
+    sign = num.sign;
+
+    return *this;
+}
+
+
+/*
+    BigInt = BigInt (move)
+    ----------------------
+*/
+
+BigInt& BigInt::operator=(BigInt&& num) noexcept {
+    limbs = std::move(num.limbs);
     sign = num.sign;
 
     return *this;
@@ -455,7 +2153,7 @@ BigInt& BigInt::operator=(const BigInt& num) {
 
 BigInt& BigInt::operator=(const long long& num) {
     BigInt temp(num);
-    value = temp.value;
+    limbs = std::move(temp.limbs);
     sign = temp.sign;
 
     return *this;
@@ -469,7 +2167,7 @@ BigInt& BigInt::operator=(const long long& num) {
 
 BigInt& BigInt::operator=(const std::string& num) {
     BigInt temp(num);
-    value = temp.value;
+    limbs = std::move(temp.limbs);
     sign = temp.sign;
 
     return *this;
@@ -511,8 +2209,8 @@ BigInt BigInt::operator+() const {
 BigInt BigInt::operator-() const {
     BigInt temp;
 
-    temp.value = value;
-    if (value != "0") {
+    temp.limbs = limbs;
+    if (!limbs.empty()) {
         if (sign == '+')
             temp.sign = '-';
         else
@@ -537,13 +2235,84 @@ BigInt BigInt::operator-() const {
 
 
 
+/*
+    is_zero
+    -------
+    Returns whether the BigInt is zero.
+*/
+
+bool BigInt::is_zero() const {
+    return limbs.empty();
+}
+
+
+/*
+    is_one
+    ------
+    Returns whether the BigInt is one.
+*/
+
+bool BigInt::is_one() const {
+    return sign == '+' and limbs.size() == 1 and limbs[0] == 1;
+}
+
+
+/*
+    fits_int64
+    ----------
+    Returns whether the BigInt is in the range of a long long int, i.e. whether
+    to_long_long will succeed.
+*/
+
+bool BigInt::fits_int64() const {
+    return limbs.empty() or (limbs.size() == 1
+                             and limbs[0] <= (uint64_t) LLONG_MAX + (sign == '-'));
+}
+
+
+/*
+    compare_magnitude
+    -----------------
+    Compares the absolute values of two BigInts, returning -1, 0 or 1 as |this|
+    is less than, equal to or greater than |num|.
+*/
+
+int BigInt::compare_magnitude(const BigInt& num) const {
+    return compare_limbs(limbs, num.limbs);
+}
+
+
+/*
+    compare_integer
+    ---------------
+    Helper function that compares a BigInt with an integer without converting
+    the integer to a BigInt, returning -1, 0 or 1.
+*/
+
+int BigInt::compare_integer(long long num) const {
+    char num_sign = num < 0 ? '-' : '+';
+    if (sign != num_sign)
+        return sign == '-' ? -1 : 1;
+
+    // same signs: compare the magnitudes, reversing the order if negative
+    int order = 1;
+    if (limbs.size() <= 1) {
+        uint64_t magnitude = limbs.empty() ? 0 : limbs[0];
+        uint64_t num_magnitude = unsigned_abs(num);
+        order = (magnitude > num_magnitude) - (magnitude < num_magnitude);
+    }
+
+    return sign == '-' ? -order : order;
+}
+
+
 /*
     BigInt == BigInt
     ----------------
 */
 
 bool BigInt::operator==(const BigInt& num) const {
-    return (sign == num.sign) and (value == num.value);
+    return (sign == num.sign) and (limbs == num.limbs);
 }
 
 
@@ -564,14 +2333,10 @@ bool BigInt::operator!=(const BigInt& num) const {
 
 bool BigInt::operator<(const BigInt& num) const {
     if (sign == num.sign) {
-        if (sign == '+') {
-            if (value.length() == num.value.length())
-                return value < num.value;
-            else
-                return value.length() < num.value.length();
-        }
+        if (sign == '+')
+            return compare_limbs(limbs, num.limbs) < 0;
         else
-            return -(*this) > -num;
+            return compare_limbs(limbs, num.limbs) > 0;
     }
     else
         return sign == '-';
@@ -614,7 +2379,7 @@ bool BigInt::operator>=(const BigInt& num) const {
 */
 
 bool BigInt::operator==(const long long& num) const {
-    return *this == BigInt(num);
+    return compare_integer(num) == 0;
 }
 
 
@@ -624,7 +2389,7 @@ bool BigInt::operator==(const long long& num) const {
 */
 
 bool operator==(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) == rhs;
+    return rhs == lhs;
 }
 
 
@@ -634,7 +2399,7 @@ bool operator==(const long long& lhs, const BigInt& rhs) {
 */
 
 bool BigInt::operator!=(const long long& num) const {
-    return !(*this == BigInt(num));
+    return compare_integer(num) != 0;
 }
 
 
@@ -644,7 +2409,7 @@ bool BigInt::operator!=(const long long& num) const {
 */
 
 bool operator!=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) != rhs;
+    return rhs != lhs;
 }
 
 
@@ -654,7 +2419,7 @@ bool operator!=(const long long& lhs, const BigInt& rhs) {
 */
 
 bool BigInt::operator<(const long long& num) const {
-    return *this < BigInt(num);
+    return compare_integer(num) < 0;
 }
 
 
@@ -664,7 +2429,7 @@ bool BigInt::operator<(const long long& num) const {
 */
 
 bool operator<(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) < rhs;
+    return rhs > lhs;
 }
 
 
@@ -674,7 +2439,7 @@ bool operator<(const long long& lhs, const BigInt& rhs) {
 */
 
 bool BigInt::operator>(const long long& num) const {
-    return *this > BigInt(num);
+    return compare_integer(num) > 0;
 }
 
 
@@ -684,7 +2449,7 @@ bool BigInt::operator>(const long long& num) const {
 */
 
 bool operator>(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) > rhs;
+    return rhs < lhs;
 }
 
 
@@ -694,7 +2459,7 @@ bool operator>(const long long& lhs, const BigInt& rhs) {
 */
 
 bool BigInt::operator<=(const long long& num) const {
-    return !(*this > BigInt(num));
+    return compare_integer(num) <= 0;
 }
 
 
@@ -704,7 +2469,7 @@ bool BigInt::operator<=(const long long& num) const {
 */
 
 bool operator<=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) <= rhs;
+    return rhs >= lhs;
 }
 
 
@@ -714,7 +2479,7 @@ bool operator<=(const long long& lhs, const BigInt& rhs) {
 */
 
 bool BigInt::operator>=(const long long& num) const {
-    return !(*this < BigInt(num));
+    return compare_integer(num) >= 0;
 }
 
 
@@ -724,7 +2489,7 @@ bool BigInt::operator>=(const long long& num) const {
 */
 
 bool operator>=(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) >= rhs;
+    return rhs <= lhs;
 }
 
 
@@ -894,12 +2659,12 @@ BigInt big_pow10(size_t exp) {
 
 BigInt pow(const BigInt& base, int exp) {
     if (exp < 0) {
-        if (base == 0)
+        if (base.is_zero())
             throw std::logic_error("Cannot divide by zero");
-        return abs(base) == 1 ? base : 0;
+        return base == 1 or base == -1 ? base : 0;
     }
     if (exp == 0) {
-        if (base == 0)
+        if (base.is_zero())
             throw std::logic_error("Zero cannot be raised to zero");
         return 1;
     }
@@ -908,7 +2673,7 @@ BigInt pow(const BigInt& base, int exp) {
     while (exp > 1) {
         if (exp % 2)
             result_odd *= result;
-        result *= result;
+        result = result.square();
         exp /= 2;
     }
 
@@ -963,45 +2728,184 @@ BigInt sqrt(const BigInt& num) {
     BigInt sqrt_prev = -1;
     // The value for `sqrt_current` is chosen close to that of the actual
     // square root.
-    // Since a number's square root has at least one less than half as many
-    // digits as the number,
-    //     sqrt_current = 10^(half_the_digits_in_num - 1)
-    BigInt sqrt_current = big_pow10(num.to_string().size() / 2 - 1);
+    // Since a number's square root has at least half as many bits as the
+    // number, rounded down,
+    //     sqrt_current = 2^((bits_in_num - 1) / 2)
+    BigInt sqrt_current;
+    sqrt_current.limbs = shift_limbs_left({1}, (bit_length(num.limbs) - 1) / 2);
 
     while (abs(sqrt_current - sqrt_prev) > 1) {
         sqrt_prev = sqrt_current;
         sqrt_current = (num / sqrt_prev + sqrt_prev) / 2;
     }
 
+    // the iteration can settle one above the integer square root
+    if (sqrt_current.square() > num)
+        sqrt_current--;
+
     return sqrt_current;
 }
 
 
+/*
+    binary_gcd
+    ----------
+    Helper function that returns the GCD of two double-width integers using the
+    binary GCD algorithm, which needs only shifts and subtractions.
+*/
+
+uint128_t binary_gcd(uint128_t num1, uint128_t num2) {
+    auto trailing_zeroes = [](uint128_t num) {
+        uint64_t low = (uint64_t) num;
+        return low ? __builtin_ctzll(low) : 64 + __builtin_ctzll((uint64_t) (num >> 64));
+    };
+
+    if (num1 == 0)
+        return num2;
+    if (num2 == 0)
+        return num1;
+
+    int shift = trailing_zeroes(num1 | num2);   // the common factor of 2
+    num1 >>= trailing_zeroes(num1);
+    do {
+        num2 >>= trailing_zeroes(num2);
+        if (num1 > num2)
+            std::swap(num1, num2);
+        num2 -= num1;
+    } while (num2 != 0);
+
+    return num1 << shift;
+}
+
+
+/*
+    leading_bits
+    ------------
+    Helper function that returns the 64 bits of a number represented as limbs
+    starting at bit `shift`.
+*/
+
+uint64_t leading_bits(const LimbVector& num, size_t shift) {
+    size_t limb = shift / 64, bit = shift % 64;
+    uint64_t bits = limb < num.size() ? num[limb] >> bit : 0;
+    if (bit and limb + 1 < num.size())
+        bits |= num[limb + 1] << (64 - bit);
+
+    return bits;
+}
+
+
+/*
+    lehmer_cofactors
+    ----------------
+    Helper function for Lehmer's GCD algorithm: runs Euclid's algorithm on the
+    leading 63 bits of `num1` >= `num2` for as long as the quotients are sure
+    to match those of the full numbers, and returns the cofactors (a, b, c, d)
+    that map the pair to a later pair of remainders, (a*num1 + b*num2,
+    c*num1 + d*num2). Each row has one positive and one non-positive entry.
+    NOTE: If not even one quotient is determined, b is 0, and the caller has to
+    take an ordinary division step instead.
+*/
+
+std::tuple<long long, long long, long long, long long> lehmer_cofactors(
+        const LimbVector& num1, const LimbVector& num2) {
+    size_t bits = bit_length(num1);
+    size_t shift = bits > 63 ? bits - 63 : 0;
+    __int128 high1 = leading_bits(num1, shift), high2 = leading_bits(num2, shift);
+
+    // the quotient is taken only if both extreme values of the true numbers
+    // give the same one (Knuth, TAOCP vol. 2, Algorithm L)
+    __int128 a = 1, b = 0, c = 0, d = 1;
+    while (high2 + c != 0 and high2 + d != 0) {
+        __int128 quotient = (high1 + a) / (high2 + c);
+        if (quotient != (high1 + b) / (high2 + d))
+            break;
+
+        __int128 next = a - quotient * c;
+        a = c;
+        c = next;
+        next = b - quotient * d;
+        b = d;
+        d = next;
+        next = high1 - quotient * high2;
+        high1 = high2;
+        high2 = next;
+    }
+
+    return std::make_tuple((long long) a, (long long) b, (long long) c,
+                           (long long) d);
+}
+
+
+/*
+    combine_limbs
+    -------------
+    Helper function that returns x*num1 + y*num2 for cofactors `x` and `y` of
+    opposite signs (or zero), whose result is known not to be negative.
+*/
+
+LimbVector combine_limbs(const LimbVector& num1, long long x,
+        const LimbVector& num2, long long y) {
+    bool first_positive = x > 0 or y <= 0;
+    LimbVector positive = first_positive ? num1 : num2;
+    LimbVector negative = first_positive ? num2 : num1;
+    multiply_add_limb(positive, unsigned_abs(first_positive ? x : y), 0);
+    multiply_add_limb(negative, unsigned_abs(first_positive ? y : x), 0);
+    subtract_limbs_in_place(positive, negative);
+
+    return positive;
+}
+
+
 /*
     gcd(BigInt, BigInt)
     -------------------
-    Returns the greatest common divisor (GCD, a.k.a. HCF) of two BigInts using
-    Euclid's algorithm.
+    Returns the greatest common divisor (GCD, a.k.a. HCF) of two BigInts.
+    NOTE: Multi-limb operands are reduced with Lehmer's algorithm, which takes
+    the steps of Euclid's algorithm a limb's worth at a time from the leading
+    bits, so each pass over the full numbers is a few single-limb
+    multiplications instead of a long division. Once both fit in two limbs the
+    binary GCD algorithm finishes natively.
 */
 
 BigInt gcd(const BigInt &num1, const BigInt &num2){
-    BigInt abs_num1 = abs(num1);
-    BigInt abs_num2 = abs(num2);
-
-    // base cases:
-    if (abs_num2 == 0)
-        return abs_num1;    // gcd(a, 0) = |a|
-    if (abs_num1 == 0)
-        return abs_num2;    // gcd(0, a) = |a|
+    LimbVector larger = num1.limbs, smaller = num2.limbs;
+    if (compare_limbs(larger, smaller) < 0)
+        std::swap(larger, smaller);
+
+    while (smaller.size() > 2) {
+        long long a, b, c, d;
+        std::tie(a, b, c, d) = lehmer_cofactors(larger, smaller);
+        if (b == 0) {   // Euclid step
+            larger = std::get<1>(divide(larger, smaller));
+            std::swap(larger, smaller);
+        }
+        else {
+            LimbVector next_smaller = combine_limbs(larger, c, smaller, d);
+            larger = combine_limbs(larger, a, smaller, b);
+            smaller = std::move(next_smaller);
+        }
+    }
 
-    BigInt remainder = abs_num2;
-    while (remainder != 0) {
-        remainder = abs_num1 % abs_num2;
-        abs_num1 = abs_num2;    // previous remainder
-        abs_num2 = remainder;   // current remainder
+    BigInt result;
+    if (smaller.empty()) {
+        result.limbs = std::move(larger);
+        return result;
     }
+    if (larger.size() > 2)
+        larger = std::get<1>(divide(larger, smaller));
+
+    auto to_native = [](const LimbVector& num) {
+        uint128_t value = 0;
+        for (size_t i = num.size(); i-- > 0; )
+            value = (value << 64) | num[i];
+        return value;
+    };
+    uint128_t native_gcd = binary_gcd(to_native(larger), to_native(smaller));
+    result.limbs = {(uint64_t) native_gcd, (uint64_t) (native_gcd >> 64)};
+    strip_leading_zeroes(result.limbs);
 
-    return abs_num1;
+    return result;
 }
 
 
@@ -1052,10 +2956,11 @@ BigInt gcd(const std::string& num1, const BigInt& num2){
 */
 
 BigInt lcm(const BigInt& num1, const BigInt& num2) {
-    if (num1 == 0 or num2 == 0)
+    if (num1.is_zero() or num2.is_zero())
         return 0;
 
-    return abs(num1 * num2) / gcd(num1, num2);
+    // dividing before multiplying keeps the intermediate product small
+    return abs(num1 / gcd(num1, num2) * num2);
 }
 
 
@@ -1099,6 +3004,93 @@ BigInt lcm(const std::string& num1, const BigInt& num2){
 }
 
 
+/*
+    ext_gcd
+    -------
+    Returns the GCD g of two BigInts together with Bezout coefficients x and y
+    such that num1*x + num2*y = g, as the tuple (g, x, y).
+    NOTE: Like gcd, this uses Lehmer's algorithm, applying each batch of steps
+    to the coefficient of `num1` as well. The coefficient of `num2` is solved
+    for at the end.
+*/
+
+std::tuple<BigInt, BigInt, BigInt> ext_gcd(const BigInt& num1, const BigInt& num2) {
+    bool swapped = compare_limbs(num1.limbs, num2.limbs) < 0;
+    BigInt first = abs(swapped ? num2 : num1), second = abs(swapped ? num1 : num2);
+
+    // larger = coeff * first + (...) * second, and likewise for smaller
+    LimbVector larger = first.limbs, smaller = second.limbs;
+    BigInt coeff = 1, next_coeff = 0;
+    while (!smaller.empty()) {
+        long long a = 1, b = 0, c = 0, d = 1;
+        if (smaller.size() > 1)
+            std::tie(a, b, c, d) = lehmer_cofactors(larger, smaller);
+
+        if (b == 0) {   // Euclid step
+            BigInt quotient;
+            LimbVector remainder;
+            std::tie(quotient.limbs, remainder) = divide(larger, smaller);
+            larger = std::move(smaller);
+            smaller = std::move(remainder);
+            BigInt temp = coeff - quotient * next_coeff;
+            coeff = std::move(next_coeff);
+            next_coeff = std::move(temp);
+        }
+        else {
+            LimbVector next_smaller = combine_limbs(larger, c, smaller, d);
+            larger = combine_limbs(larger, a, smaller, b);
+            smaller = std::move(next_smaller);
+            BigInt temp = coeff * c + next_coeff * d;
+            coeff = coeff * a + next_coeff * b;
+            next_coeff = std::move(temp);
+        }
+    }
+
+    BigInt g;
+    g.limbs = std::move(larger);
+    BigInt other_coeff = second.is_zero() ? BigInt(0) : (g - coeff * first) / second;
+
+    // undo taking the absolute values and ordering the operands
+    BigInt x = swapped ? other_coeff : coeff;
+    BigInt y = swapped ? coeff : other_coeff;
+    if (num1.sign == '-')
+        x = -x;
+    if (num2.sign == '-')
+        y = -y;
+
+    return std::make_tuple(g, x, y);
+}
+
+
+/*
+    mod_inverse
+    -----------
+    Returns the inverse of a BigInt modulo `modulus`, in the range [0, modulus),
+    using the extended GCD.
+    NOTE: If the modulus is less than 2, or the BigInt is not coprime to it, an
+    invalid_argument exception is thrown.
+*/
+
+BigInt mod_inverse(const BigInt& num, const BigInt& modulus) {
+    if (modulus < 2)
+        throw std::invalid_argument("Expected a modulus greater than 1");
+
+    BigInt reduced = num % modulus;
+    if (reduced < 0)
+        reduced += modulus;
+    BigInt g, inverse, unused;
+    std::tie(g, inverse, unused) = ext_gcd(reduced, modulus);
+    if (!g.is_one())
+        throw std::invalid_argument("Value has no inverse modulo the given modulus");
+
+    inverse %= modulus;
+    if (inverse < 0)
+        inverse += modulus;
+
+    return inverse;
+}
+
+
 #endif  // BIG_INT_MATH_FUNCTIONS_HPP
 
 
@@ -1112,13 +3104,9 @@ BigInt lcm(const std::string& num1, const BigInt& num2){
 #define BIG_INT_BINARY_ARITHMETIC_OPERATORS_HPP
 
 #include <climits>
-#include <cmath>
 #include <string>
 
 
-const long long FLOOR_SQRT_LLONG_MAX = 3037000499;
-
-
 /*
     BigInt + BigInt
     ---------------
@@ -1138,24 +3126,11 @@ BigInt BigInt::operator+(const BigInt& num) const {
         return -(lhs - num);
     }
 
-    // identify the numbers as `larger` and `smaller`
-    std::string larger, smaller;
-    std::tie(larger, smaller) = get_larger_and_smaller(this->value, num.value);
-
     BigInt result;      // the resultant sum
-    result.value = "";  // the value is cleared as the digits will be appended
-    short carry = 0, sum;
-    // add the two values
-    for (long i = larger.size() - 1; i >= 0; i--) {
-        sum = larger[i] - '0' + smaller[i] - '0' + carry;
-        result.value = std::to_string(sum % 10) + result.value;
-        carry = sum / (short) 10;
-    }
-    if (carry)
-        result.value = std::to_string(carry) + result.value;
+    result.limbs = add_limbs(this->limbs, num.limbs);
 
     // if the operands are negative, the result is negative
-    if (this->sign == '-' and result.value != "0")
+    if (this->sign == '-' and !result.limbs.empty())
         result.sign = '-';
 
     return result;
@@ -1182,127 +3157,275 @@ BigInt BigInt::operator-(const BigInt& num) const {
     }
 
     BigInt result;      // the resultant difference
-    // identify the numbers as `larger` and `smaller`
-    std::string larger, smaller;
-    if (abs(*this) > abs(num)) {
-        larger = this->value;
-        smaller = num.value;
+    if (compare_limbs(this->limbs, num.limbs) >= 0) {
+        result.limbs = subtract_limbs(this->limbs, num.limbs);
 
         if (this->sign == '-')      // -larger - -smaller = -result
             result.sign = '-';
     }
     else {
-        larger = num.value;
-        smaller = this->value;
+        result.limbs = subtract_limbs(num.limbs, this->limbs);
 
         if (num.sign == '+')        // smaller - larger = -result
             result.sign = '-';
     }
-    // pad the smaller number with zeroes
-    add_leading_zeroes(smaller, larger.size() - smaller.size());
-
-    result.value = "";  // the value is cleared as the digits will be appended
-    short difference;
-    long i, j;
-    // subtract the two values
-    for (i = larger.size() - 1; i >= 0; i--) {
-        difference = larger[i] - smaller[i];
-        if (difference < 0) {
-            for (j = i - 1; j >= 0; j--) {
-                if (larger[j] != '0') {
-                    larger[j]--;    // borrow from the j-th digit
-                    break;
-                }
+
+    // if the result is 0, set its sign as +
+    if (result.limbs.empty())
+        result.sign = '+';
+
+    return result;
+}
+
+
+/*
+    BigInt * BigInt
+    ---------------
+    Computes the product of two BigInts using the schoolbook method, Karatsuba's
+    algorithm, Toom-3 or NTT convolution, depending on the operand sizes.
+    The operand on the RHS of the product is `num`.
+*/
+
+BigInt BigInt::operator*(const BigInt& num) const {
+    if (is_zero() or num.is_zero())
+        return BigInt(0);
+    if (is_one())
+        return num;
+    if (num.is_one())
+        return *this;
+
+    if (this == &num)
+        return square();
+
+    BIG_INT_COUNT(MULTIPLY, limbs.size(), num.limbs.size());
+    BigInt product;
+    product.limbs = multiply_limbs(this->limbs, num.limbs);
+
+    if (this->sign == num.sign)
+        product.sign = '+';
+    else
+        product.sign = '-';
+
+    return product;
+}
+
+
+/*
+    square
+    ------
+    Returns the square of a BigInt. Since both operands are the same, each
+    cross product of limbs is only computed once, saving up to half the work
+    of a general product.
+*/
+
+BigInt BigInt::square() const {
+    BIG_INT_COUNT(MULTIPLY, limbs.size(), limbs.size());
+    BigInt result;
+    result.limbs = square_limbs(this->limbs);
+
+    return result;
+}
+
+
+/*
+    divide_knuth
+    ------------
+    Helper function that returns the quotient and remainder on dividing the
+    magnitude `dividend` by the magnitude `divisor` of at least two limbs,
+    using Knuth's Algorithm D (schoolbook long division in base 2^64).
+*/
+
+std::tuple<LimbVector, LimbVector> divide_knuth(
+        const LimbVector& dividend, const LimbVector& divisor) {
+    if (compare_limbs(dividend, divisor) < 0)
+        return std::make_tuple(LimbVector(), dividend);
+
+    // normalise so that the divisor's top limb has its highest bit set, which
+    // keeps each estimated quotient limb within 2 of the actual one
+    int shift = __builtin_clzll(divisor.back());
+    LimbVector v = shift_limbs_left(divisor, shift);
+    LimbVector u = shift_limbs_left(dividend, shift);
+    size_t n = v.size(), m = dividend.size() - n;
+    u.resize(m + n + 1, 0);
+
+    LimbVector quotient(m + 1, 0);
+    for (size_t j = m + 1; j-- > 0; ) {
+        // estimate the quotient limb from the top two limbs of the remainder
+        uint128_t numerator = ((uint128_t) u[j + n] << 64) | u[j + n - 1];
+        uint128_t q_hat = numerator / v[n - 1];
+        uint128_t r_hat = numerator % v[n - 1];
+        while ((q_hat >> 64) or
+               q_hat * v[n - 2] > ((r_hat << 64) | u[j + n - 2])) {
+            q_hat--;
+            r_hat += v[n - 1];
+            if (r_hat >> 64)
+                break;
+        }
+
+        // subtract q_hat * v from the current window of u
+        uint64_t borrow = 0, carry = 0;
+        for (size_t i = 0; i <= n; i++) {
+            uint64_t product_limb = carry;
+            if (i < n) {
+                uint128_t product = q_hat * v[i] + carry;
+                product_limb = (uint64_t) product;
+                carry = (uint64_t) (product >> 64);
             }
-            j++;
-            while (j != i) {
-                larger[j] = '9';    // add the borrow and take away 1
-                j++;
+            uint64_t difference = u[i + j] - product_limb;
+            uint64_t next_borrow = u[i + j] < product_limb;
+            next_borrow |= difference < borrow;
+            u[i + j] = difference - borrow;
+            borrow = next_borrow;
+        }
+
+        // the estimate was one too large, so add one v back
+        if (borrow) {
+            q_hat--;
+            carry = 0;
+            for (size_t i = 0; i < n; i++) {
+                uint128_t limb_sum = (uint128_t) u[i + j] + v[i] + carry;
+                u[i + j] = (uint64_t) limb_sum;
+                carry = (uint64_t) (limb_sum >> 64);
             }
-            difference += 10;   // add the borrow
+            u[j + n] += carry;
         }
-        result.value = std::to_string(difference) + result.value;
+        quotient[j] = (uint64_t) q_hat;
     }
-    strip_leading_zeroes(result.value);
+    strip_leading_zeroes(quotient);
+
+    u.resize(n);
+    strip_leading_zeroes(u);
+
+    return std::make_tuple(std::move(quotient), shift_limbs_right(u, shift));
+}
+
+
+std::tuple<LimbVector, LimbVector> divide_2n_by_n(
+        LimbVector, LimbVector, size_t);
+
+
+/*
+    divide_3n_by_2n
+    ---------------
+    Helper function for Burnikel-Ziegler division that divides the 3-part
+    number [dividend_high, dividend_low], where `dividend_low` has `n` limbs,
+    by the normalised 2-part divisor [divisor_high, divisor_low].
+*/
 
-    // if the result is 0, set its sign as +
-    if (result.value == "0")
-        result.sign = '+';
+std::tuple<LimbVector, LimbVector> divide_3n_by_2n(
+        const LimbVector& dividend_high,
+        const LimbVector& dividend_low,
+        const LimbVector& divisor,
+        const LimbVector& divisor_high,
+        const LimbVector& divisor_low, size_t n) {
+    LimbVector top, rest;
+    std::tie(top, rest) = split_limbs(dividend_high, n);
+
+    // estimate the quotient from the top two parts and the divisor's top part
+    LimbVector quotient, remainder;
+    if (compare_limbs(top, divisor_high) == 0) {
+        quotient.assign(n, UINT64_MAX);
+        remainder = rest;
+        add_limbs_shifted(remainder, divisor_high, 0);
+    }
+    else
+        std::tie(quotient, remainder) = divide_2n_by_n(dividend_high, divisor_high, n);
+
+    // correct the estimate, which is at most 2 too large
+    if (!remainder.empty())
+        remainder.insert(remainder.begin(), n, 0);
+    add_limbs_shifted(remainder, dividend_low, 0);
+    LimbVector correction = multiply_limbs(quotient, divisor_low);
+    while (compare_limbs(remainder, correction) < 0) {
+        subtract_limbs_in_place(quotient, {1});
+        add_limbs_shifted(remainder, divisor, 0);
+    }
+    subtract_limbs_in_place(remainder, correction);
 
-    return result;
+    return std::make_tuple(std::move(quotient), std::move(remainder));
 }
 
 
 /*
-    BigInt * BigInt
-    ---------------
-    Computes the product of two BigInts using Karatsuba's algorithm.
-    The operand on the RHS of the product is `num`.
+    divide_2n_by_n
+    --------------
+    Helper function for Burnikel-Ziegler division that divides `dividend`,
+    which is less than `divisor * 2^(64n)`, by the normalised `n`-limb
+    `divisor`, recursing on halves until the divisor is small enough for
+    Algorithm D.
 */
 
-BigInt BigInt::operator*(const BigInt& num) const {
-    if (*this == 0 or num == 0)
-        return BigInt(0);
-    if (*this == 1)
-        return num;
-    if (num == 1)
-     return *this;
-
-    BigInt product;
-    if (abs(*this) <= FLOOR_SQRT_LLONG_MAX and abs(num) <= FLOOR_SQRT_LLONG_MAX)
-        product = std::stoll(this->value) * std::stoll(num.value);
-    else if (is_power_of_10(this->value)){ // if LHS is a power of 10 do optimised operation 
-        product.value = num.value;
-        product.value.append(this->value.begin() + 1, this->value.end());
+std::tuple<LimbVector, LimbVector> divide_2n_by_n(
+        LimbVector dividend, LimbVector divisor, size_t n) {
+    if (n < BURNIKEL_ZIEGLER_THRESHOLD)
+        return divide_knuth(dividend, divisor);
+
+    // an odd number of limbs is padded with a zero limb at the bottom
+    bool pad = n % 2;
+    if (pad) {
+        if (!dividend.empty())
+            dividend.insert(dividend.begin(), 0);
+        divisor.insert(divisor.begin(), 0);
+        n++;
     }
-    else if (is_power_of_10(num.value)){ // if RHS is a power of 10 do optimised operation 
-        product.value = this->value;
-        product.value.append(num.value.begin() + 1, num.value.end());
-    }
-    else {
-        // identify the numbers as `larger` and `smaller`
-        std::string larger, smaller;
-        std::tie(larger, smaller) = get_larger_and_smaller(this->value, num.value);
+    size_t half = n / 2;
 
-        size_t half_length = larger.size() / 2;
-        auto half_length_ceil = (size_t) ceil(larger.size() / 2.0);
+    LimbVector divisor_high, divisor_low;
+    std::tie(divisor_high, divisor_low) = split_limbs(divisor, half);
 
-        BigInt num1_high, num1_low;
-        num1_high = larger.substr(0, half_length);
-        num1_low = larger.substr(half_length);
+    LimbVector dividend_top, dividend_rest, dividend_mid, dividend_low;
+    std::tie(dividend_top, dividend_rest) = split_limbs(dividend, n);
+    std::tie(dividend_mid, dividend_low) = split_limbs(dividend_rest, half);
 
-        BigInt num2_high, num2_low;
-        num2_high = smaller.substr(0, half_length);
-        num2_low = smaller.substr(half_length);
+    LimbVector quotient_high, quotient_low, remainder;
+    std::tie(quotient_high, remainder) = divide_3n_by_2n(
+        dividend_top, dividend_mid, divisor, divisor_high, divisor_low, half);
+    std::tie(quotient_low, remainder) = divide_3n_by_2n(
+        remainder, dividend_low, divisor, divisor_high, divisor_low, half);
 
-        strip_leading_zeroes(num1_high.value);
-        strip_leading_zeroes(num1_low.value);
-        strip_leading_zeroes(num2_high.value);
-        strip_leading_zeroes(num2_low.value);
+    if (pad and !remainder.empty())
+        remainder.erase(remainder.begin());
+    add_limbs_shifted(quotient_low, quotient_high, half);
 
-        BigInt prod_high, prod_mid, prod_low;
-        prod_high = num1_high * num2_high;
-        prod_low = num1_low * num2_low;
-        prod_mid = (num1_high + num1_low) * (num2_high + num2_low)
-                   - prod_high - prod_low;
+    return std::make_tuple(std::move(quotient_low), std::move(remainder));
+}
 
-        add_trailing_zeroes(prod_high.value, 2 * half_length_ceil);
-        add_trailing_zeroes(prod_mid.value, half_length_ceil);
 
-        strip_leading_zeroes(prod_high.value);
-        strip_leading_zeroes(prod_mid.value);
-        strip_leading_zeroes(prod_low.value);
+/*
+    divide_burnikel_ziegler
+    -----------------------
+    Helper function that returns the quotient and remainder on dividing the
+    magnitude `dividend` by the magnitude `divisor` using Burnikel and
+    Ziegler's recursive division, which benefits from fast multiplication.
+*/
 
-        product = prod_high + prod_mid + prod_low;
+std::tuple<LimbVector, LimbVector> divide_burnikel_ziegler(
+        const LimbVector& dividend, const LimbVector& divisor) {
+    int shift = __builtin_clzll(divisor.back());
+    LimbVector normalised_divisor = shift_limbs_left(divisor, shift);
+    LimbVector normalised_dividend = shift_limbs_left(dividend, shift);
+    size_t n = normalised_divisor.size();
+
+    // divide the dividend as a sequence of n-limb digits, most significant
+    // first, carrying the remainder from one digit into the next
+    LimbVector quotient, remainder;
+    for (size_t d = (normalised_dividend.size() + n - 1) / n; d-- > 0; ) {
+        LimbVector digit(
+            normalised_dividend.begin() + d * n,
+            normalised_dividend.begin() + std::min((d + 1) * n, normalised_dividend.size()));
+        strip_leading_zeroes(digit);
+
+        if (!remainder.empty())
+            remainder.insert(remainder.begin(), n, 0);
+        add_limbs_shifted(remainder, digit, 0);
+
+        LimbVector quotient_digit;
+        std::tie(quotient_digit, remainder) = divide_2n_by_n(remainder, normalised_divisor, n);
+        add_limbs_shifted(quotient, quotient_digit, d * n);
     }
-    strip_leading_zeroes(product.value);
-
-    if (this->sign == num.sign)
-        product.sign = '+';
-    else
-        product.sign = '-';
+    strip_leading_zeroes(quotient);
 
-    return product;
+    return std::make_tuple(std::move(quotient), shift_limbs_right(remainder, shift));
 }
 
 
@@ -1310,91 +3433,66 @@ BigInt BigInt::operator*(const BigInt& num) const {
     divide
     ------
     Helper function that returns the quotient and remainder on dividing the
-    dividend by the divisor, when the divisor is 1 to 10 times the dividend.
+    magnitude `dividend` by the non-zero magnitude `divisor`.
 */
 
-std::tuple<BigInt, BigInt> divide(const BigInt& dividend, const BigInt& divisor) {
-    BigInt quotient, remainder, temp;
+std::tuple<LimbVector, LimbVector> divide(
+        const LimbVector& dividend, const LimbVector& divisor) {
+    if (compare_limbs(dividend, divisor) < 0)
+        return std::make_tuple(LimbVector(), dividend);
 
-    temp = divisor;
-    quotient = 1;
-    while (temp < dividend) {
-        quotient++;
-        temp += divisor;
-    }
-    if (temp > dividend) {
-        quotient--;
-        remainder = dividend - (temp - divisor);
+    if (divisor.size() == 1) {
+        LimbVector quotient = dividend, remainder;
+        uint64_t limb_remainder = divide_limb(quotient, divisor[0]);
+        if (limb_remainder)
+            remainder.push_back(limb_remainder);
+
+        return std::make_tuple(std::move(quotient), std::move(remainder));
     }
+    if (divisor.size() < BURNIKEL_ZIEGLER_THRESHOLD or
+            dividend.size() - divisor.size() < BURNIKEL_ZIEGLER_THRESHOLD)
+        return divide_knuth(dividend, divisor);
+
+    return divide_burnikel_ziegler(dividend, divisor);
+}
+
+
+/*
+    divmod
+    ------
+    Returns the quotient and remainder on dividing two BigInts, from a single
+    division. The quotient is truncated towards zero, and the remainder has the
+    same sign as the dividend (as with `/` and `%`).
+*/
+
+std::tuple<BigInt, BigInt> divmod(const BigInt& dividend, const BigInt& divisor) {
+    if (divisor.limbs.empty())
+        throw std::logic_error("Attempted division by zero");
 
-    return std::make_tuple(quotient, remainder);
+    BIG_INT_COUNT(DIVIDE, dividend.limbs.size(), divisor.limbs.size());
+    BigInt quotient, remainder;
+    std::tie(quotient.limbs, remainder.limbs) = divide(dividend.limbs, divisor.limbs);
+
+    if (!quotient.limbs.empty() and dividend.sign != divisor.sign)
+        quotient.sign = '-';
+    if (!remainder.limbs.empty())
+        remainder.sign = dividend.sign;
+
+    return std::make_tuple(std::move(quotient), std::move(remainder));
 }
 
 
 /*
     BigInt / BigInt
     ---------------
-    Computes the quotient of two BigInts using the long-division method.
+    Computes the quotient of two BigInts, using Algorithm D or Burnikel-Ziegler
+    division depending on the sizes of the operands.
     The operand on the RHS of the division (the divisor) is `num`.
 */
 
 BigInt BigInt::operator/(const BigInt& num) const {
-    BigInt abs_dividend = abs(*this);
-    BigInt abs_divisor = abs(num);
-
-    if (num == 0)
-        throw std::logic_error("Attempted division by zero");
-    if (abs_dividend < abs_divisor)
-        return BigInt(0);
-    if (num == 1)
-        return *this;
-    if (num == -1)
-        return -(*this);
-
-    BigInt quotient;
-    if (abs_dividend <= LLONG_MAX and abs_divisor <= LLONG_MAX)
-        quotient = std::stoll(abs_dividend.value) / std::stoll(abs_divisor.value);
-    else if (abs_dividend == abs_divisor)
-        quotient = 1;
-    else if (is_power_of_10(abs_divisor.value)) { // if divisor is a power of 10 do optimised calculation
-        size_t digits_in_quotient = abs_dividend.value.size() - abs_divisor.value.size() + 1;
-        quotient.value = abs_dividend.value.substr(0, digits_in_quotient);
-    }
-    else {
-        quotient.value = "";    // the value is cleared as digits will be appended
-        BigInt chunk, chunk_quotient, chunk_remainder;
-        size_t chunk_index = 0;
-        chunk_remainder.value = abs_dividend.value.substr(chunk_index, abs_divisor.value.size() - 1);
-        chunk_index = abs_divisor.value.size() - 1;
-        while (chunk_index < abs_dividend.value.size()) {
-            chunk.value = chunk_remainder.value.append(1, abs_dividend.value[chunk_index]);
-            chunk_index++;
-            while (chunk < abs_divisor) {
-                quotient.value += "0";
-                if (chunk_index < abs_dividend.value.size()) {
-                    chunk.value.append(1, abs_dividend.value[chunk_index]);
-                    chunk_index++;
-                }
-                else
-                    break;
-            }
-            if (chunk == abs_divisor) {
-                quotient.value += "1";
-                chunk_remainder = 0;
-            }
-            else if (chunk > abs_divisor) {
-                strip_leading_zeroes(chunk.value);
-                std::tie(chunk_quotient, chunk_remainder) = divide(chunk, abs_divisor);
-                quotient.value += chunk_quotient.value;
-            }
-        }
-    }
-    strip_leading_zeroes(quotient.value);
-
-    if (this->sign == num.sign)
-        quotient.sign = '+';
-    else
-        quotient.sign = '-';
+    BigInt quotient, remainder;
+    std::tie(quotient, remainder) = divmod(*this, num);
 
     return quotient;
 }
@@ -1408,33 +3506,8 @@ BigInt BigInt::operator/(const BigInt& num) const {
 */
 
 BigInt BigInt::operator%(const BigInt& num) const {
-    BigInt abs_dividend = abs(*this);
-    BigInt abs_divisor = abs(num);
-
-    if (abs_divisor == 0)
-        throw std::logic_error("Attempted division by zero");
-    if (abs_divisor == 1 or abs_divisor == abs_dividend)
-        return BigInt(0);
-
-    BigInt remainder;
-    if (abs_dividend <= LLONG_MAX and abs_divisor <= LLONG_MAX)
-        remainder = std::stoll(abs_dividend.value) % std::stoll(abs_divisor.value);
-    else if (abs_dividend < abs_divisor)
-        remainder = abs_dividend;
-    else if (is_power_of_10(num.value)){ // if num is a power of 10 use optimised calculation
-        size_t no_of_zeroes = num.value.size() - 1;
-        remainder.value = abs_dividend.value.substr(abs_dividend.value.size() - no_of_zeroes);
-    } 
-    else {
-        BigInt quotient = abs_dividend / abs_divisor;
-        remainder = abs_dividend - quotient * abs_divisor;
-    }
-    strip_leading_zeroes(remainder.value);
-
-    // remainder has the same sign as that of the dividend
-    remainder.sign = this->sign;
-    if (remainder.value == "0")     // except if its zero
-        remainder.sign = '+';
+    BigInt quotient, remainder;
+    std::tie(quotient, remainder) = divmod(*this, num);
 
     return remainder;
 }
@@ -1446,7 +3519,10 @@ BigInt BigInt::operator%(const BigInt& num) const {
 */
 
 BigInt BigInt::operator+(const long long& num) const {
-    return *this + BigInt(num);
+    BigInt result = *this;
+    result += num;
+
+    return result;
 }
 
 
@@ -1456,7 +3532,7 @@ BigInt BigInt::operator+(const long long& num) const {
 */
 
 BigInt operator+(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) + rhs;
+    return rhs + lhs;
 }
 
 
@@ -1466,7 +3542,10 @@ BigInt operator+(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator-(const long long& num) const {
-    return *this - BigInt(num);
+    BigInt result = *this;
+    result -= num;
+
+    return result;
 }
 
 
@@ -1476,7 +3555,7 @@ BigInt BigInt::operator-(const long long& num) const {
 */
 
 BigInt operator-(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) - rhs;
+    return -(rhs - lhs);
 }
 
 
@@ -1486,7 +3565,10 @@ BigInt operator-(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator*(const long long& num) const {
-    return *this * BigInt(num);
+    BigInt product = *this;
+    product *= num;
+
+    return product;
 }
 
 
@@ -1496,7 +3578,7 @@ BigInt BigInt::operator*(const long long& num) const {
 */
 
 BigInt operator*(const long long& lhs, const BigInt& rhs) {
-    return BigInt(lhs) * rhs;
+    return rhs * lhs;
 }
 
 
@@ -1506,7 +3588,10 @@ BigInt operator*(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator/(const long long& num) const {
-    return *this / BigInt(num);
+    BigInt quotient = *this;
+    quotient /= num;
+
+    return quotient;
 }
 
 
@@ -1526,7 +3611,19 @@ BigInt operator/(const long long& lhs, const BigInt& rhs) {
 */
 
 BigInt BigInt::operator%(const long long& num) const {
-    return *this % BigInt(num);
+    if (num == 0)
+        throw std::logic_error("Attempted division by zero");
+
+    // remainder has the same sign as that of the dividend, unless it is zero
+    BIG_INT_COUNT(WORD_DIVIDE, limbs.size(), 1);
+    BigInt remainder;
+    uint64_t limb_remainder = remainder_limb(this->limbs, unsigned_abs(num));
+    if (limb_remainder) {
+        remainder.limbs.push_back(limb_remainder);
+        remainder.sign = this->sign;
+    }
+
+    return remainder;
 }
 
 
@@ -1653,13 +3750,78 @@ BigInt operator%(const std::string& lhs, const BigInt& rhs) {
 
 
 
+/*
+    add_signed_magnitude
+    --------------------
+    Helper function that adds a magnitude with the given sign to a BigInt in
+    place.
+*/
+
+void BigInt::add_signed_magnitude(const LimbVector& magnitude,
+        char magnitude_sign) {
+    if (sign == magnitude_sign)
+        add_limbs_shifted(limbs, magnitude, 0);
+    else if (compare_limbs(limbs, magnitude) >= 0)
+        subtract_limbs_in_place(limbs, magnitude);
+    else {
+        limbs = subtract_limbs(magnitude, limbs);
+        sign = magnitude_sign;
+    }
+
+    if (limbs.empty())  // zero is always positive
+        sign = '+';
+}
+
+
+/*
+    add_signed_limb
+    ---------------
+    Helper function that adds a single-limb magnitude with the given sign to a
+    BigInt in place.
+*/
+
+void BigInt::add_signed_limb(uint64_t magnitude, char magnitude_sign) {
+    if (magnitude == 0)
+        return;
+
+    if (limbs.empty()) {
+        limbs.push_back(magnitude);
+        sign = magnitude_sign;
+    }
+    else if (sign == magnitude_sign) {
+        // propagate the carry, which starts out as the magnitude itself
+        for (size_t i = 0; magnitude; i++) {
+            if (i == limbs.size())
+                limbs.push_back(0);
+            limbs[i] += magnitude;
+            magnitude = limbs[i] < magnitude;
+        }
+    }
+    else if (limbs.size() > 1 or limbs[0] >= magnitude) {
+        // propagate the borrow, which starts out as the magnitude itself
+        for (size_t i = 0; magnitude; i++) {
+            uint64_t borrow = limbs[i] < magnitude;
+            limbs[i] -= magnitude;
+            magnitude = borrow;
+        }
+        strip_leading_zeroes(limbs);
+        if (limbs.empty())  // zero is always positive
+            sign = '+';
+    }
+    else {
+        limbs[0] = magnitude - limbs[0];
+        sign = magnitude_sign;
+    }
+}
+
+
 /*
     BigInt += BigInt
     ----------------
 */
 
 BigInt& BigInt::operator+=(const BigInt& num) {
-    *this = *this + num;
+    add_signed_magnitude(num.limbs, num.sign);
 
     return *this;
 }
@@ -1671,7 +3833,7 @@ BigInt& BigInt::operator+=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator-=(const BigInt& num) {
-    *this = *this - num;
+    add_signed_magnitude(num.limbs, num.sign == '+' ? '-' : '+');
 
     return *this;
 }
@@ -1683,7 +3845,15 @@ BigInt& BigInt::operator-=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator*=(const BigInt& num) {
-    *this = *this * num;
+    if (limbs.empty() or num.limbs.empty()) {
+        limbs.clear();
+        sign = '+';
+    }
+    else {
+        BIG_INT_COUNT(MULTIPLY, limbs.size(), num.limbs.size());
+        limbs = multiply_limbs(limbs, num.limbs);
+        sign = sign == num.sign ? '+' : '-';
+    }
 
     return *this;
 }
@@ -1695,7 +3865,15 @@ BigInt& BigInt::operator*=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator/=(const BigInt& num) {
-    *this = *this / num;
+    if (num.limbs.empty())
+        throw std::logic_error("Attempted division by zero");
+
+    BIG_INT_COUNT(DIVIDE, limbs.size(), num.limbs.size());
+    LimbVector remainder;
+    std::tie(limbs, remainder) = divide(limbs, num.limbs);
+    sign = sign == num.sign ? '+' : '-';
+    if (limbs.empty())
+        sign = '+';
 
     return *this;
 }
@@ -1707,7 +3885,15 @@ BigInt& BigInt::operator/=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator%=(const BigInt& num) {
-    *this = *this % num;
+    if (num.limbs.empty())
+        throw std::logic_error("Attempted division by zero");
+
+    // the remainder keeps the sign of the dividend, unless it is zero
+    BIG_INT_COUNT(DIVIDE, limbs.size(), num.limbs.size());
+    LimbVector quotient;
+    std::tie(quotient, limbs) = divide(limbs, num.limbs);
+    if (limbs.empty())
+        sign = '+';
 
     return *this;
 }
@@ -1719,7 +3905,7 @@ BigInt& BigInt::operator%=(const BigInt& num) {
 */
 
 BigInt& BigInt::operator+=(const long long& num) {
-    *this = *this + BigInt(num);
+    add_signed_limb(unsigned_abs(num), num < 0 ? '-' : '+');
 
     return *this;
 }
@@ -1731,7 +3917,7 @@ BigInt& BigInt::operator+=(const long long& num) {
 */
 
 BigInt& BigInt::operator-=(const long long& num) {
-    *this = *this - BigInt(num);
+    add_signed_limb(unsigned_abs(num), num < 0 ? '+' : '-');
 
     return *this;
 }
@@ -1743,7 +3929,16 @@ BigInt& BigInt::operator-=(const long long& num) {
 */
 
 BigInt& BigInt::operator*=(const long long& num) {
-    *this = *this * BigInt(num);
+    if (num == 0 or limbs.empty()) {
+        limbs.clear();
+        sign = '+';
+    }
+    else {
+        BIG_INT_COUNT(WORD_MULTIPLY, limbs.size(), 1);
+        multiply_add_limb(limbs, unsigned_abs(num), 0);
+        if (num < 0)
+            sign = sign == '+' ? '-' : '+';
+    }
 
     return *this;
 }
@@ -1755,7 +3950,15 @@ BigInt& BigInt::operator*=(const long long& num) {
 */
 
 BigInt& BigInt::operator/=(const long long& num) {
-    *this = *this / BigInt(num);
+    if (num == 0)
+        throw std::logic_error("Attempted division by zero");
+
+    BIG_INT_COUNT(WORD_DIVIDE, limbs.size(), 1);
+    divide_limb(limbs, unsigned_abs(num));
+    if (num < 0)
+        sign = sign == '+' ? '-' : '+';
+    if (limbs.empty())
+        sign = '+';
 
     return *this;
 }
@@ -1767,7 +3970,7 @@ BigInt& BigInt::operator/=(const long long& num) {
 */
 
 BigInt& BigInt::operator%=(const long long& num) {
-    *this = *this % BigInt(num);
+    *this = *this % num;
 
     return *this;
 }
@@ -1779,7 +3982,7 @@ BigInt& BigInt::operator%=(const long long& num) {
 */
 
 BigInt& BigInt::operator+=(const std::string& num) {
-    *this = *this + BigInt(num);
+    *this += BigInt(num);
 
     return *this;
 }
@@ -1791,7 +3994,7 @@ BigInt& BigInt::operator+=(const std::string& num) {
 */
 
 BigInt& BigInt::operator-=(const std::string& num) {
-    *this = *this - BigInt(num);
+    *this -= BigInt(num);
 
     return *this;
 }
@@ -1803,7 +4006,7 @@ BigInt& BigInt::operator-=(const std::string& num) {
 */
 
 BigInt& BigInt::operator*=(const std::string& num) {
-    *this = *this * BigInt(num);
+    *this *= BigInt(num);
 
     return *this;
 }
@@ -1815,7 +4018,7 @@ BigInt& BigInt::operator*=(const std::string& num) {
 */
 
 BigInt& BigInt::operator/=(const std::string& num) {
-    *this = *this / BigInt(num);
+    *this /= BigInt(num);
 
     return *this;
 }
@@ -1827,7 +4030,7 @@ BigInt& BigInt::operator/=(const std::string& num) {
 */
 
 BigInt& BigInt::operator%=(const std::string& num) {
-    *this = *this % BigInt(num);
+    *this %= BigInt(num);
 
     return *this;
 }
@@ -1933,9 +4136,7 @@ std::istream& operator>>(std::istream& in, BigInt& num) {
 */
 
 std::ostream& operator<<(std::ostream& out, const BigInt& num) {
-    if (num.sign == '-')
-        out << num.sign;
-    out << num.value;
+    out << num.to_string();
 
     return out;
 }
@@ -1943,3 +4144,303 @@ std::ostream& operator<<(std::ostream& out, const BigInt& num) {
 #endif  // BIG_INT_IO_STREAM_OPERATORS_HPP
 
 
+/*
+    ===========================================================================
+    Montgomery modular arithmetic
+    ===========================================================================
+    Fixed-width arithmetic modulo an odd modulus, with residues kept in
+    Montgomery form (x * R mod modulus, where R = 2^(64 * limbs in modulus)).
+*/
+
+#ifndef BIG_INT_MONTGOMERY_HPP
+#define BIG_INT_MONTGOMERY_HPP
+
+#include <stdexcept>
+
+
+class Montgomery {
+    LimbVector modulus;
+    uint64_t modulus_inverse;           // -modulus^(-1) mod 2^64
+    LimbVector r_squared;    // R^2 mod modulus
+
+    void multiply_cios(uint64_t*, const LimbVector&, const LimbVector&) const;
+
+    public:
+        // every residue has exactly as many limbs as the modulus
+        typedef LimbVector Residue;
+
+        Montgomery(const BigInt&);
+
+        // Conversion functions:
+        Residue to_montgomery(const BigInt&) const;
+        BigInt from_montgomery(const Residue&) const;
+        BigInt get_modulus() const;
+
+        // Arithmetic functions:
+        Residue one() const;
+        bool is_zero(const Residue&) const;
+        Residue add(const Residue&, const Residue&) const;
+        Residue subtract(const Residue&, const Residue&) const;
+        Residue multiply(const Residue&, const Residue&) const;
+        void multiply(Residue&, const Residue&, const Residue&, Residue&) const;
+        Residue inverse(const Residue&) const;
+};
+
+
+/*
+    Modulus to Montgomery context
+    -----------------------------
+    NOTE: If the modulus is not an odd integer of at least 3, an
+    invalid_argument exception is thrown.
+*/
+
+Montgomery::Montgomery(const BigInt& num) {
+    if (num < 3 or num.limbs[0] % 2 == 0)
+        throw std::invalid_argument("Expected an odd modulus of at least 3, got "
+                                    + num.to_string());
+    modulus = num.limbs;
+
+    // Newton's iteration doubles the number of correct low bits each step,
+    // starting from the 3 bits that any odd number is its own inverse for
+    uint64_t inverse = modulus[0];
+    for (int i = 0; i < 5; i++)
+        inverse *= 2 - modulus[0] * inverse;
+    modulus_inverse = 0 - inverse;
+
+    LimbVector r_power(2 * modulus.size() + 1, 0), quotient;
+    r_power.back() = 1;
+    std::tie(quotient, r_squared) = divide(r_power, modulus);
+    r_squared.resize(modulus.size(), 0);
+}
+
+
+/*
+    to_montgomery
+    -------------
+    Reduces a BigInt modulo the modulus and converts it to Montgomery form.
+*/
+
+Montgomery::Residue Montgomery::to_montgomery(const BigInt& num) const {
+    BigInt modulus_num;
+    modulus_num.limbs = modulus;
+    BigInt reduced = num % modulus_num;
+    if (reduced < 0)
+        reduced += modulus_num;
+
+    Residue residue = reduced.limbs;
+    residue.resize(modulus.size(), 0);
+
+    return multiply(residue, r_squared);
+}
+
+
+/*
+    from_montgomery
+    ---------------
+    Converts a residue in Montgomery form back to a BigInt in [0, modulus).
+*/
+
+BigInt Montgomery::from_montgomery(const Residue& residue) const {
+    Residue unit(modulus.size(), 0);
+    unit[0] = 1;
+
+    BigInt num;
+    num.limbs = multiply(residue, unit);
+    strip_leading_zeroes(num.limbs);
+
+    return num;
+}
+
+
+/*
+    get_modulus
+    -----------
+*/
+
+BigInt Montgomery::get_modulus() const {
+    BigInt num;
+    num.limbs = modulus;
+
+    return num;
+}
+
+
+/*
+    one
+    ---
+    Returns the residue of 1 in Montgomery form.
+*/
+
+Montgomery::Residue Montgomery::one() const {
+    return to_montgomery(1);
+}
+
+
+/*
+    is_zero
+    -------
+*/
+
+bool Montgomery::is_zero(const Residue& residue) const {
+    for (uint64_t limb : residue)
+        if (limb != 0)
+            return false;
+
+    return true;
+}
+
+
+/*
+    add
+    ---
+    Returns (num1 + num2) mod modulus.
+*/
+
+Montgomery::Residue Montgomery::add(const Residue& num1, const Residue& num2) const {
+    size_t n = modulus.size();
+    Residue sum(n);
+    uint64_t carry = add_limbs_n(sum.data(), num1.data(), num2.data(), n);
+
+    // subtract the modulus if the sum overflowed or is not below it
+    if (carry or compare_limbs_n(sum.data(), modulus.data(), n) >= 0)
+        subtract_limbs_n(sum.data(), sum.data(), modulus.data(), n);
+
+    return sum;
+}
+
+
+/*
+    subtract
+    --------
+    Returns (num1 - num2) mod modulus.
+*/
+
+Montgomery::Residue Montgomery::subtract(const Residue& num1, const Residue& num2) const {
+    size_t n = modulus.size();
+    Residue difference(n);
+    uint64_t borrow = subtract_limbs_n(difference.data(), num1.data(),
+                                       num2.data(), n);
+
+    // add the modulus back if the difference went negative
+    if (borrow)
+        add_limbs_n(difference.data(), difference.data(), modulus.data(), n);
+
+    return difference;
+}
+
+
+/*
+    multiply_cios
+    -------------
+    Helper function that writes num1 * num2 * R^(-1) mod modulus to the first
+    limbs of `product`, which has room for two more limbs than the modulus and
+    starts out as zero, using the coarsely integrated operand scanning (CIOS)
+    method.
+*/
+
+void Montgomery::multiply_cios(uint64_t* product, const LimbVector& num1,
+        const LimbVector& num2) const {
+    size_t n = modulus.size();
+    for (size_t i = 0; i < n; i++) {
+        // product += num1 * num2[i]
+        uint64_t carry = 0;
+        for (size_t j = 0; j < n; j++) {
+            uint128_t limb_product = (uint128_t) num1[j] * num2[i] + product[j] + carry;
+            product[j] = (uint64_t) limb_product;
+            carry = (uint64_t) (limb_product >> 64);
+        }
+        uint128_t limb_sum = (uint128_t) product[n] + carry;
+        product[n] = (uint64_t) limb_sum;
+        product[n + 1] = (uint64_t) (limb_sum >> 64);
+
+        // product = (product + m * modulus) / 2^64, where m makes it divisible
+        uint64_t m = product[0] * modulus_inverse;
+        uint128_t limb_product = (uint128_t) m * modulus[0] + product[0];
+        carry = (uint64_t) (limb_product >> 64);
+        for (size_t j = 1; j < n; j++) {
+            limb_product = (uint128_t) m * modulus[j] + product[j] + carry;
+            product[j - 1] = (uint64_t) limb_product;
+            carry = (uint64_t) (limb_product >> 64);
+        }
+        limb_sum = (uint128_t) product[n] + carry;
+        product[n - 1] = (uint64_t) limb_sum;
+        product[n] = product[n + 1] + (uint64_t) (limb_sum >> 64);
+    }
+
+    // the product is below twice the modulus, so at most one subtraction is
+    // needed to bring it into range
+    bool reduce = product[n] != 0;
+    for (size_t i = n; !reduce and i-- > 0; ) {
+        if (product[i] != modulus[i]) {
+            reduce = product[i] > modulus[i];
+            break;
+        }
+        if (i == 0)
+            reduce = true;
+    }
+    if (reduce) {
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < n; i++) {
+            uint128_t difference = (uint128_t) product[i] - modulus[i] - borrow;
+            product[i] = (uint64_t) difference;
+            borrow = (uint64_t) (difference >> 64) & 1;
+        }
+    }
+}
+
+
+/*
+    multiply
+    --------
+    Returns num1 * num2 * R^(-1) mod modulus.
+*/
+
+Montgomery::Residue Montgomery::multiply(const Residue& num1, const Residue& num2) const {
+    Residue product(modulus.size() + 2, 0);
+    multiply_cios(product.data(), num1, num2);
+    product.resize(modulus.size());
+
+    return product;
+}
+
+
+/*
+    multiply(into, with scratch)
+    ----------------------------
+    Stores num1 * num2 * R^(-1) mod modulus in `product`, which may be either
+    operand, working in `scratch`, which may not.
+    NOTE: Passing the same scratch residue to a run of calls avoids allocating
+    on every multiplication, as the value-returning form does.
+*/
+
+void Montgomery::multiply(Residue& product, const Residue& num1,
+        const Residue& num2, Residue& scratch) const {
+    size_t n = modulus.size();
+    scratch.assign(n + 2, 0);
+    multiply_cios(scratch.data(), num1, num2);
+    product.assign(scratch.begin(), scratch.begin() + n);
+}
+
+
+/*
+    inverse
+    -------
+    Returns the multiplicative inverse of a residue in Montgomery form.
+    NOTE: If the residue is not invertible, an invalid_argument exception is
+    thrown.
+*/
+
+Montgomery::Residue Montgomery::inverse(const Residue& residue) const {
+    // the plain inverse of x R is x^(-1) R^(-1), and each Montgomery
+    // multiplication by R^2 contributes a factor of R to bring it back to
+    // x^(-1) R
+    BigInt plain;
+    plain.limbs = residue;
+    strip_leading_zeroes(plain.limbs);
+    Residue inverse = mod_inverse(plain, get_modulus()).limbs;
+    inverse.resize(modulus.size(), 0);
+
+    return multiply(multiply(inverse, r_squared), r_squared);
+}
+
+#endif  // BIG_INT_MONTGOMERY_HPP
@@ -0,0 +1,372 @@
+#ifndef FIXED_BIG_INT_HPP
+#define FIXED_BIG_INT_HPP
+
+#include <array>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "BigInt.hpp"
+
+/**
+ * @brief A signed integer of a fixed width of `Bits` bits, stored in place with no heap use.
+ *
+ * The value is kept in two's complement in Bits / 64 limbs, least significant first, so
+ * nothing is ever allocated. Addition, subtraction, comparison and multiplication run over
+ * that compile-time limb count, the multiplication fully unrolled. Division normalises by the
+ * operands' significant limbs, as Algorithm D needs, so its loops run to those lengths.
+ * It is constexpr, so constants can be built at compile time. Unlike native integers it never
+ * wraps: a result outside (-2^(Bits-1), 2^(Bits-1)) raises std::overflow_error. The range is
+ * symmetric, leaving out -2^(Bits-1), so every value has a negation and a magnitude that fit.
+ *
+ * Division and remainder truncate toward zero, as with BigInt.
+ */
+template <size_t Bits>
+class FixedBigInt {
+    static_assert(Bits >= 64 && Bits % 64 == 0, "FixedBigInt needs a positive multiple of 64 bits");
+
+public:
+    static constexpr size_t LIMBS = Bits / 64;
+    typedef std::array<uint64_t, LIMBS> Limbs;
+
+    constexpr FixedBigInt() : limbs{} {}
+
+    /**
+     * @throws std::overflow_error for LLONG_MIN when Bits is 64, as it is out of range.
+     */
+    constexpr FixedBigInt(long long value) : limbs{} {
+        if (LIMBS == 1 && value == LLONG_MIN) overflow();
+        limbs[0] = (uint64_t)value;
+        for (size_t i = 1; i < LIMBS; i++) limbs[i] = value < 0 ? UINT64_MAX : 0;
+    }
+
+    /**
+     * @throws std::overflow_error if the value needs more than `Bits` bits.
+     */
+    static FixedBigInt from_big_int(const BigInt& num) {
+        std::vector<uint64_t> magnitude = num.to_limbs();
+        FixedBigInt result;
+        if (magnitude.size() > LIMBS) overflow();
+        for (size_t i = 0; i < magnitude.size(); i++) result.limbs[i] = magnitude[i];
+        if (result.is_negative()) overflow();
+        return num < 0 ? -result : result;
+    }
+
+    BigInt to_big_int() const {
+        Limbs magnitude = magnitudeOf(*this);
+        BigInt result = BigInt::from_limbs(magnitude.data(), LIMBS);
+        return is_negative() ? -result : result;
+    }
+
+    /**
+     * @brief Parses a number in the given base, with the same rules as BigInt::from_string.
+     *
+     * @throws std::invalid_argument if the string is not a valid number in the base.
+     * @throws std::overflow_error if the value needs more than `Bits` bits.
+     */
+    static FixedBigInt from_string(std::string_view digits, int base) {
+        return from_big_int(BigInt::from_string(digits, base));
+    }
+
+    std::string to_string() const { return to_big_int().to_string(); }
+
+    constexpr bool is_negative() const { return limbs[LIMBS - 1] >> 63; }
+
+    constexpr bool is_zero() const {
+        for (size_t i = 0; i < LIMBS; i++) {
+            if (limbs[i] != 0) return false;
+        }
+        return true;
+    }
+
+    constexpr FixedBigInt operator-() const { return negated(*this); }
+
+    constexpr FixedBigInt operator+(const FixedBigInt& num) const {
+        FixedBigInt sum;
+        uint64_t carry = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            unsigned __int128 limb_sum = (unsigned __int128)limbs[i] + num.limbs[i] + carry;
+            sum.limbs[i] = (uint64_t)limb_sum;
+            carry = (uint64_t)(limb_sum >> 64);
+        }
+        if (is_negative() == num.is_negative() && sum.is_negative() != is_negative()) overflow();
+        if (isMostNegative(sum)) overflow();
+        return sum;
+    }
+
+    constexpr FixedBigInt operator-(const FixedBigInt& num) const {
+        FixedBigInt difference;
+        uint64_t borrow = 0;
+        for (size_t i = 0; i < LIMBS; i++) {
+            unsigned __int128 limb_difference = (unsigned __int128)limbs[i] - num.limbs[i] - borrow;
+            difference.limbs[i] = (uint64_t)limb_difference;
+            borrow = (uint64_t)(limb_difference >> 64) & 1;
+        }
+        if (is_negative() != num.is_negative() && difference.is_negative() != is_negative()) overflow();
+        if (isMostNegative(difference)) overflow();
+        return difference;
+    }
+
+    /**
+     * @brief Multiplies the magnitudes by schoolbook multiplication, keeping only the low limbs.
+     *
+     * Both loops run over the compile-time limb count and are unrolled, so the product is a
+     * straight run of LIMBS * (LIMBS + 1) / 2 multiply-adds with no branches on the operands.
+     *
+     * @throws std::overflow_error if the product does not fit.
+     */
+    constexpr FixedBigInt operator*(const FixedBigInt& num) const {
+        Limbs a = magnitudeOf(*this), b = magnitudeOf(num);
+        // with this bound every partial product a[i] * b[j] with i + j >= LIMBS is zero,
+        // so the low triangle below holds the whole product and only carries can spill over
+        if (significantLimbs(a) + significantLimbs(b) > LIMBS + 1) overflow();
+
+        FixedBigInt product;
+        uint64_t spilled = 0;
+#pragma GCC unroll 16
+        for (size_t i = 0; i < LIMBS; i++) {
+            uint64_t carry = 0;
+#pragma GCC unroll 16
+            for (size_t j = 0; j < LIMBS - i; j++) {
+                unsigned __int128 limb_product = (unsigned __int128)a[i] * b[j] + product.limbs[i + j] + carry;
+                product.limbs[i + j] = (uint64_t)limb_product;
+                carry = (uint64_t)(limb_product >> 64);
+            }
+            spilled |= carry;
+        }
+        if (spilled != 0 || product.is_negative()) overflow();
+        return is_negative() != num.is_negative() ? negated(product) : product;
+    }
+
+    /**
+     * @throws std::logic_error on division by zero.
+     */
+    constexpr FixedBigInt operator/(const FixedBigInt& num) const {
+        FixedBigInt quotient, remainder;
+        divide(*this, num, quotient, remainder);
+        return quotient;
+    }
+
+    /**
+     * @throws std::logic_error on division by zero.
+     */
+    constexpr FixedBigInt operator%(const FixedBigInt& num) const {
+        FixedBigInt quotient, remainder;
+        divide(*this, num, quotient, remainder);
+        return remainder;
+    }
+
+    constexpr FixedBigInt& operator+=(const FixedBigInt& num) { return *this = *this + num; }
+    constexpr FixedBigInt& operator-=(const FixedBigInt& num) { return *this = *this - num; }
+    constexpr FixedBigInt& operator*=(const FixedBigInt& num) { return *this = *this * num; }
+    constexpr FixedBigInt& operator/=(const FixedBigInt& num) { return *this = *this / num; }
+    constexpr FixedBigInt& operator%=(const FixedBigInt& num) { return *this = *this % num; }
+
+    constexpr bool operator==(const FixedBigInt& num) const {
+        for (size_t i = 0; i < LIMBS; i++) {
+            if (limbs[i] != num.limbs[i]) return false;
+        }
+        return true;
+    }
+
+    constexpr bool operator<(const FixedBigInt& num) const {
+        if (is_negative() != num.is_negative()) return is_negative();
+        for (size_t i = LIMBS; i-- > 0; ) { // same sign: two's complement orders like unsigned
+            if (limbs[i] != num.limbs[i]) return limbs[i] < num.limbs[i];
+        }
+        return false;
+    }
+
+    constexpr bool operator!=(const FixedBigInt& num) const { return !(*this == num); }
+    constexpr bool operator>(const FixedBigInt& num) const { return num < *this; }
+    constexpr bool operator<=(const FixedBigInt& num) const { return !(num < *this); }
+    constexpr bool operator>=(const FixedBigInt& num) const { return !(*this < num); }
+
+    friend std::ostream& operator<<(std::ostream& out, const FixedBigInt& num) {
+        return out << num.to_string();
+    }
+
+    /**
+     * @brief Returns the greatest common divisor of |num1| and |num2|.
+     */
+    friend constexpr FixedBigInt gcd(FixedBigInt num1, FixedBigInt num2) {
+        if (num1.is_negative()) num1 = -num1;
+        if (num2.is_negative()) num2 = -num2;
+        while (!num2.is_zero()) {
+            FixedBigInt remainder = num1 % num2;
+            num1 = num2;
+            num2 = remainder;
+        }
+        return num1;
+    }
+
+    /**
+     * @brief Returns the inverse of num modulo modulus, in [0, modulus), by the extended Euclidean algorithm.
+     *
+     * @throws std::invalid_argument if the modulus is less than 2, or num is not coprime to it.
+     */
+    friend constexpr FixedBigInt mod_inverse(const FixedBigInt& num, const FixedBigInt& modulus) {
+        if (modulus < 2) throw std::invalid_argument("Expected a modulus greater than 1");
+
+        FixedBigInt remainder_prev = num % modulus, remainder = modulus;
+        if (remainder_prev.is_negative()) remainder_prev += modulus;
+        FixedBigInt coeff_prev = 1, coeff = 0; // both stay within (-modulus, modulus)
+        while (!remainder.is_zero()) {
+            FixedBigInt quotient, next_remainder;
+            divide(remainder_prev, remainder, quotient, next_remainder);
+            remainder_prev = remainder;
+            remainder = next_remainder;
+            FixedBigInt next_coeff = coeff_prev - quotient * coeff;
+            coeff_prev = coeff;
+            coeff = next_coeff;
+        }
+        if (remainder_prev != 1) throw std::invalid_argument("Value has no inverse modulo the given modulus");
+
+        return coeff_prev.is_negative() ? coeff_prev + modulus : coeff_prev;
+    }
+
+private:
+    [[noreturn]] static void overflow() {
+        throw std::overflow_error("Value does not fit in " + std::to_string(Bits) + " bits");
+    }
+
+    static constexpr FixedBigInt negated(const FixedBigInt& num) {
+        FixedBigInt result;
+        uint64_t carry = 1;
+        for (size_t i = 0; i < LIMBS; i++) {
+            result.limbs[i] = ~num.limbs[i] + carry;
+            carry = carry && result.limbs[i] == 0;
+        }
+        return result;
+    }
+
+    /**
+     * @brief Whether num is -2^(Bits-1), the one two's complement value left out of the range.
+     */
+    static constexpr bool isMostNegative(const FixedBigInt& num) {
+        if (num.limbs[LIMBS - 1] != (uint64_t)1 << 63) return false;
+        for (size_t i = 0; i + 1 < LIMBS; i++) {
+            if (num.limbs[i] != 0) return false;
+        }
+        return true;
+    }
+
+    static constexpr Limbs magnitudeOf(const FixedBigInt& num) {
+        return num.is_negative() ? negated(num).limbs : num.limbs;
+    }
+
+    static constexpr size_t significantLimbs(const Limbs& num) {
+        size_t length = LIMBS;
+        while (length > 0 && num[length - 1] == 0) length--;
+        return length;
+    }
+
+    /**
+     * @brief Divides the two-limb value (high, low) by `divisor`, which must exceed `high`.
+     *
+     * On x86-64 this is a single divq, where the generic 128-bit division is a library call.
+     */
+    static uint64_t divideWide(uint64_t high, uint64_t low, uint64_t divisor, uint64_t& remainder) {
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+        uint64_t quotient;
+        __asm__("divq %4" : "=a"(quotient), "=d"(remainder) : "a"(low), "d"(high), "rm"(divisor));
+        return quotient;
+#else
+        unsigned __int128 dividend = ((unsigned __int128)high << 64) | low;
+        remainder = (uint64_t)(dividend % divisor);
+        return (uint64_t)(dividend / divisor);
+#endif
+    }
+
+    /**
+     * @brief Divides with truncation toward zero, using Knuth's Algorithm D on the magnitudes.
+     */
+    static constexpr void divide(const FixedBigInt& dividend, const FixedBigInt& divisor,
+                                 FixedBigInt& quotient, FixedBigInt& remainder) {
+        Limbs u = magnitudeOf(dividend), v = magnitudeOf(divisor);
+        size_t m = significantLimbs(u), n = significantLimbs(v);
+        if (n == 0) throw std::logic_error("Attempted division by zero");
+
+        quotient = FixedBigInt();
+        remainder = FixedBigInt();
+        if (m < n) {
+            remainder.limbs = u;
+        } else if (n == 1) { // short division by a single limb
+            unsigned __int128 rest = 0;
+            for (size_t i = m; i-- > 0; ) {
+                unsigned __int128 current = (rest << 64) | u[i];
+                quotient.limbs[i] = (uint64_t)(current / v[0]);
+                rest = current % v[0];
+            }
+            remainder.limbs[0] = (uint64_t)rest;
+        } else {
+            // normalise so that the top limb of the divisor has its high bit set
+            int shift = __builtin_clzll(v[n - 1]);
+            uint64_t vn[LIMBS] = {}, un[LIMBS + 1] = {};
+            for (size_t i = n; i-- > 0; ) {
+                vn[i] = (v[i] << shift) | (shift && i > 0 ? v[i - 1] >> (64 - shift) : 0);
+            }
+            un[m] = shift ? u[m - 1] >> (64 - shift) : 0;
+            for (size_t i = m; i-- > 0; ) {
+                un[i] = (u[i] << shift) | (shift && i > 0 ? u[i - 1] >> (64 - shift) : 0);
+            }
+
+            for (size_t j = m - n + 1; j-- > 0; ) {
+                // estimate the quotient limb from the top two limbs, then correct it
+                unsigned __int128 q_hat = 0, r_hat = 0;
+                if (un[j + n] < vn[n - 1] && !__builtin_is_constant_evaluated()) {
+                    uint64_t limb_remainder = 0;
+                    q_hat = divideWide(un[j + n], un[j + n - 1], vn[n - 1], limb_remainder);
+                    r_hat = limb_remainder;
+                } else {
+                    unsigned __int128 top = ((unsigned __int128)un[j + n] << 64) | un[j + n - 1];
+                    q_hat = top / vn[n - 1];
+                    r_hat = top - q_hat * vn[n - 1];
+                }
+                while (q_hat >> 64 || q_hat * vn[n - 2] > ((r_hat << 64) | un[j + n - 2])) {
+                    q_hat--;
+                    r_hat += vn[n - 1];
+                    if (r_hat >> 64) break;
+                }
+
+                // multiply and subtract
+                __int128 borrow = 0, difference = 0;
+                for (size_t i = 0; i < n; i++) {
+                    unsigned __int128 product = q_hat * vn[i];
+                    difference = (__int128)un[i + j] - borrow - (uint64_t)product;
+                    un[i + j] = (uint64_t)difference;
+                    borrow = (__int128)(uint64_t)(product >> 64) - (difference >> 64);
+                }
+                difference = (__int128)un[j + n] - borrow;
+                un[j + n] = (uint64_t)difference;
+
+                quotient.limbs[j] = (uint64_t)q_hat;
+                if (difference < 0) { // the estimate was one too large: add the divisor back
+                    quotient.limbs[j]--;
+                    uint64_t carry = 0;
+                    for (size_t i = 0; i < n; i++) {
+                        unsigned __int128 limb_sum = (unsigned __int128)un[i + j] + vn[i] + carry;
+                        un[i + j] = (uint64_t)limb_sum;
+                        carry = (uint64_t)(limb_sum >> 64);
+                    }
+                    un[j + n] += carry;
+                }
+            }
+
+            for (size_t i = 0; i < n; i++) { // undo the normalisation
+                remainder.limbs[i] = (un[i] >> shift) | (shift ? un[i + 1] << (64 - shift) : 0);
+            }
+        }
+
+        if (dividend.is_negative() != divisor.is_negative()) quotient = negated(quotient);
+        if (dividend.is_negative()) remainder = negated(remainder);
+    }
+
+    Limbs limbs;
+};
+
+#endif // FIXED_BIG_INT_HPP
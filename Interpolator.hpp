@@ -0,0 +1,118 @@
+#ifndef INTERPOLATOR_HPP
+#define INTERPOLATOR_HPP
+
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "BigInt.hpp"
+
+/**
+ * @brief An exact polynomial interpolator over the integers that keeps its state in Newton form.
+ *
+ * For nodes x_0, ..., x_{k-1} the polynomial is held as
+ *
+ *     P(x) = (1 / denominator) * sum_j coefficients[j] * prod_{i < j} (x - x_i),
+ *
+ * i.e. the Newton divided differences over one common denominator, so every update is
+ * plain integer arithmetic. Adding a point, removing any point and evaluating each take
+ * O(k) BigInt operations, which makes streaming shares and subset searches that change
+ * one point at a time cheap compared with re-running lagrange_interpolate_at_zero.
+ */
+class Interpolator {
+public:
+    size_t size() const { return xs.size(); }
+    const std::vector<long long>& nodes() const { return xs; }
+
+    /**
+     * @brief Extends the polynomial to also pass through (x, y).
+     *
+     * The new divided difference is (y - P(x)) / prod_i (x - x_i), reduced to lowest terms
+     * and brought onto the common denominator.
+     *
+     * @throws std::invalid_argument if x is already a node.
+     */
+    void add_point(long long x, const BigInt& y) {
+        BigInt node_product = 1; // prod_i (x - x_i)
+        for (long long node : xs) node_product *= BigInt(x) - node;
+        if (node_product == 0) {
+            throw std::invalid_argument("Duplicate x-coordinate " + std::to_string(x));
+        }
+
+        BigInt numerator = y * denominator - numeratorAt(x);
+        BigInt term_denominator = denominator * node_product;
+        if (term_denominator < 0) {
+            term_denominator = -term_denominator;
+            numerator = -numerator;
+        }
+        BigInt divisor = gcd(numerator, term_denominator);
+        numerator /= divisor;
+        term_denominator /= divisor;
+
+        BigInt common_denominator = lcm(denominator, term_denominator);
+        BigInt scale = common_denominator / denominator;
+        if (scale != 1) {
+            for (BigInt& coefficient : coefficients) coefficient *= scale;
+        }
+        coefficients.push_back(numerator * (common_denominator / term_denominator));
+        denominator = common_denominator;
+        xs.push_back(x);
+    }
+
+    /**
+     * @brief Removes the node x, leaving the polynomial through the remaining points.
+     *
+     * The node is moved to the end one adjacent swap at a time; swapping nodes t and t+1
+     * only changes coefficient t, to c_t + c_{t+1} (x_{t+1} - x_t). The last node is then dropped.
+     *
+     * @throws std::invalid_argument if x is not a node.
+     */
+    void remove_point(long long x) {
+        auto position = std::find(xs.begin(), xs.end(), x);
+        if (position == xs.end()) {
+            throw std::invalid_argument("No point with x-coordinate " + std::to_string(x));
+        }
+        for (size_t t = position - xs.begin(); t + 1 < xs.size(); t++) {
+            coefficients[t] += coefficients[t + 1] * (BigInt(xs[t + 1]) - xs[t]);
+            std::swap(xs[t], xs[t + 1]);
+        }
+        xs.pop_back();
+        coefficients.pop_back();
+        if (xs.empty()) denominator = 1;
+    }
+
+    /**
+     * @brief Evaluates the polynomial at x (by default, the constant term P(0)).
+     *
+     * @throws std::runtime_error if P(x) is not an integer.
+     */
+    BigInt evaluate(long long x = 0) const {
+        BigInt numerator = numeratorAt(x);
+        BigInt result, remainder;
+        std::tie(result, remainder) = divmod(numerator, denominator);
+        if (remainder != 0) {
+            throw std::runtime_error("P(" + std::to_string(x) + ") = " + numerator.to_string() + "/"
+                                     + denominator.to_string() + " is not an integer. Check the shares for corruption.");
+        }
+        return result;
+    }
+
+private:
+    /**
+     * @brief Computes denominator * P(x) by Horner's rule on the Newton form.
+     */
+    BigInt numeratorAt(long long x) const {
+        BigInt result = 0;
+        for (size_t j = xs.size(); j-- > 0; ) {
+            result *= BigInt(x) - xs[j];
+            result += coefficients[j];
+        }
+        return result;
+    }
+
+    std::vector<long long> xs;          // the nodes, in Newton order
+    std::vector<BigInt> coefficients;   // the divided differences, scaled by `denominator`
+    BigInt denominator = 1;
+};
+
+#endif // INTERPOLATOR_HPP
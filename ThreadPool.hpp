@@ -0,0 +1,263 @@
+#ifndef THREAD_POOL_HPP
+#define THREAD_POOL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief A fixed-size work-stealing thread pool.
+ *
+ * Every worker owns a task queue. Tasks submitted from a worker go to the back of its
+ * own queue, and tasks submitted from elsewhere are spread round-robin. A worker takes
+ * its newest task first and, when its queue is empty, steals the oldest task of
+ * another worker, so long and short tasks balance across the threads.
+ */
+class ThreadPool {
+public:
+    /**
+     * @param num_threads The number of worker threads; 0 means one per hardware thread.
+     */
+    explicit ThreadPool(size_t num_threads) {
+        if (num_threads == 0) num_threads = std::max(1u, std::thread::hardware_concurrency());
+        for (size_t i = 0; i < num_threads; i++) {
+            queues.push_back(std::make_unique<WorkQueue>());
+        }
+        for (size_t i = 0; i < num_threads; i++) {
+            workers.emplace_back([this, i] { workerLoop(i); });
+        }
+    }
+
+    /**
+     * @brief Runs every task that is still queued, then joins the workers.
+     */
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& worker : workers) worker.join();
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    size_t size() const { return workers.size(); }
+
+    /**
+     * @brief Queues a task. Exceptions must not escape it (see TaskGroup).
+     */
+    void submit(std::function<void()> task) {
+        const WorkerIdentity& self = currentWorker();
+        size_t index = self.pool == this ? self.index : next_queue++ % queues.size();
+        {
+            // counted under the queue lock, which popTask takes too, so the task cannot be
+            // taken, and `pending` decremented, before it is counted
+            std::lock_guard<std::mutex> lock(queues[index]->mutex);
+            queues[index]->tasks.push_back(std::move(task));
+            pending++;
+        }
+        {
+            // a worker checks `pending` and starts waiting under this lock, so once it is
+            // taken here that worker has either seen the new count or will be notified
+            std::lock_guard<std::mutex> lock(sleep_mutex);
+        }
+        wake.notify_one();
+    }
+
+private:
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    struct WorkerIdentity {
+        const ThreadPool* pool = nullptr;
+        size_t index = 0;
+    };
+
+    static WorkerIdentity& currentWorker() {
+        static thread_local WorkerIdentity identity;
+        return identity;
+    }
+
+    /**
+     * @brief Takes the newest task of queue `preferred`, or else steals the oldest task of another queue.
+     */
+    bool popTask(size_t preferred, std::function<void()>& task) {
+        for (size_t offset = 0; offset < queues.size(); offset++) {
+            WorkQueue& queue = *queues[(preferred + offset) % queues.size()];
+            std::lock_guard<std::mutex> lock(queue.mutex);
+            if (queue.tasks.empty()) continue;
+            if (offset == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            pending--;
+            return true;
+        }
+        return false;
+    }
+
+    void workerLoop(size_t index) {
+        currentWorker() = {this, index};
+        while (true) {
+            std::function<void()> task;
+            if (popTask(index, task)) {
+                task();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex);
+            wake.wait(lock, [this] { return stopping || pending > 0; });
+            if (stopping && pending == 0) return;
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    std::atomic<size_t> pending{0}; // tasks queued but not yet taken
+    bool stopping = false;
+};
+
+
+/**
+ * @brief A set of tasks on a ThreadPool that can be waited for together.
+ *
+ * The tasks are held by the group, and the pool is only given one ticket per task that runs
+ * the group's next task, if any is left. wait() runs the remaining tasks on the calling thread
+ * and then sleeps until the ones taken by workers finish, so a waiting thread only ever runs
+ * work of its own group: it is never held up by an unrelated task, such as a whole other
+ * file, and its stack cannot pile up with foreign tasks. Nothing deadlocks either, since a
+ * waiter only sleeps once every task of its group is running on some thread.
+ *
+ * The first exception thrown by a task is captured and rethrown by wait().
+ */
+class TaskGroup {
+public:
+    explicit TaskGroup(ThreadPool& pool) : pool(pool), state(std::make_shared<State>()) {}
+
+    ~TaskGroup() {
+        try { wait(); } catch (...) {}
+    }
+
+    void run(std::function<void()> task) {
+        {
+            std::lock_guard<std::mutex> lock(state->mutex);
+            state->tasks.push_back(std::move(task));
+            state->remaining++;
+        }
+        // tickets may run after the group is gone, so they share the state rather than `this`
+        pool.submit([state = state] { state->runNext(); });
+    }
+
+    /**
+     * @brief Runs the group's tasks on the calling thread until every one of them has finished.
+     */
+    void wait() {
+        while (state->runNext()) {}
+        std::unique_lock<std::mutex> lock(state->mutex);
+        state->finished.wait(lock, [this] { return state->remaining == 0; });
+        if (state->error) std::rethrow_exception(std::exchange(state->error, nullptr));
+    }
+
+private:
+    struct State {
+        std::mutex mutex;
+        std::condition_variable finished;
+        std::deque<std::function<void()>> tasks; // not yet started
+        size_t remaining = 0;                    // not yet finished
+        std::exception_ptr error;
+
+        /**
+         * @brief Runs the oldest task not yet started, if there is one.
+         */
+        bool runNext() {
+            std::function<void()> task;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                if (tasks.empty()) return false;
+                task = std::move(tasks.front());
+                tasks.pop_front();
+            }
+            std::exception_ptr thrown;
+            try {
+                task();
+            } catch (...) {
+                thrown = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            if (thrown && !error) error = thrown;
+            if (--remaining == 0) finished.notify_all();
+            return true;
+        }
+    };
+
+    ThreadPool& pool;
+    std::shared_ptr<State> state;
+};
+
+
+/**
+ * @brief Calls body(i) for every i in [0, count), split into contiguous chunks on the pool.
+ *
+ * With a null pool the loop simply runs on the calling thread.
+ *
+ * @throws The first exception thrown by body, once every chunk has finished.
+ */
+template <class Body>
+void parallelFor(ThreadPool* pool, size_t count, const Body& body) {
+    if (pool == nullptr || count < 2) {
+        for (size_t i = 0; i < count; i++) body(i);
+        return;
+    }
+    size_t chunks = std::min(count, pool->size() * 4);
+    TaskGroup group(*pool);
+    for (size_t c = 0; c < chunks; c++) {
+        size_t begin = count * c / chunks, end = count * (c + 1) / chunks;
+        group.run([&body, begin, end] {
+            for (size_t i = begin; i < end; i++) body(i);
+        });
+    }
+    group.wait();
+}
+
+
+/**
+ * @brief Folds the values with an associative `combine` as a balanced binary tree.
+ *
+ * Each level combines neighbouring pairs in parallel, so k values take log2(k) rounds,
+ * and operands stay balanced in size, which suits big-number sums and lcms.
+ *
+ * @return The combination of all values, or `identity` if there are none.
+ */
+template <class T, class Combine>
+T reduceTree(std::vector<T> values, ThreadPool* pool, T identity, const Combine& combine) {
+    if (values.empty()) return identity;
+    for (size_t stride = 1; stride < values.size(); stride *= 2) {
+        size_t pairs = (values.size() + stride - 1) / (2 * stride);
+        parallelFor(pool, pairs, [&](size_t m) {
+            size_t i = 2 * stride * m;
+            values[i] = combine(values[i], values[i + stride]);
+        });
+    }
+    return std::move(values[0]);
+}
+
+#endif // THREAD_POOL_HPP
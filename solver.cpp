@@ -4,128 +4,2343 @@
 #include <string>
 #include <stdexcept>
 #include <algorithm>
+#include <chrono>
+#include <cmath>
 #include <utility>
+#include <sstream>
+#include <iomanip>
+#include <future>
+#include <iterator>
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <list>
+#include <thread>
+#include <string_view>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
 #include "nlohmann/json.hpp"
 #include "BigInt.hpp"
+#include "FixedBigInt.hpp"
+#include "ThreadPool.hpp"
+#include "Interpolator.hpp"
 
 // Use the nlohmann json namespace for convenience
 using json = nlohmann::json;
+using ordered_json = nlohmann::ordered_json; // keeps keys in insertion order, for the benchmark results
 
 /**
- * @brief Converts a number string from a given base to its BigInt representation.
+ * @brief Converts a number string from a given base to an integer of type T (BigInt by default).
+ *
+ * @throws std::invalid_argument if the string contains a digit that is invalid for the base.
+ * @throws std::overflow_error if T is a FixedBigInt too narrow for the value.
+ */
+template <class T = BigInt>
+T convertToBase10(std::string_view numStr, int base) {
+    return T::from_string(numStr, base);
+}
+
+/**
+ * @brief Converts a 128-bit integer to a BigInt.
+ */
+BigInt toBigInt(__int128 value) {
+    // the magnitude can be 2^127, so it is built from 32-bit pieces, which all fit in a long long
+    unsigned __int128 magnitude = value < 0 ? -(unsigned __int128)value : value;
+    BigInt result = 0;
+    for (int shift = 96; shift >= 0; shift -= 32) {
+        result = result * (1LL << 32) + (long long)((magnitude >> shift) & 0xffffffff);
+    }
+    return value < 0 ? -result : result;
+}
+
+
+/**
+ * @brief Multiplies together the differences x_j - x_i for every i != j.
+ *
+ * The product is accumulated in 128-bit arithmetic and only spills into a BigInt
+ * when the next factor would overflow, which for small keys is never.
+ */
+BigInt basisDenominator(const std::vector<long long>& xs, size_t j) {
+    BigInt product = 1;
+    __int128 native_product = 1;
+    for (size_t i = 0; i < xs.size(); i++) {
+        if (i == j) continue;
+        __int128 factor = (__int128)xs[j] - xs[i];
+        __int128 next;
+        if (__builtin_mul_overflow(native_product, factor, &next)) {
+            product *= toBigInt(native_product);
+            next = factor;
+        }
+        native_product = next;
+    }
+    return product * toBigInt(native_product);
+}
+
+
+/**
+ * @brief The Lagrange basis weights at x = 0 for one set of x-coordinates.
+ *
+ * The weights depend only on the x-coordinates, so one set serves every secret shared
+ * over the same share holders, and each reconstruction is then a dot product with the y values.
+ * Over the integers P(0) = (sum_j y_j * scaled[j]) / denominator; over a prime field
+ * P(0) = sum_j y_j * residues[j], with the weights in Montgomery form.
+ */
+struct LagrangeWeights {
+    std::vector<long long> xs;
+    std::vector<BigInt> scaled;                 // integer weights over the common denominator
+    BigInt denominator = 1;
+    std::shared_ptr<const Montgomery> field;    // set for prime field weights
+    std::vector<Montgomery::Residue> residues;
+};
+
+
+/**
+ * @brief Computes the Lagrange weights at 0 over the integers.
+ *
+ * The basis numerators prod_{i != j} (0 - x_i) are built from prefix and suffix
+ * products in O(k) multiplications, and the weights are put over a common
+ * denominator (the lcm of the basis denominators), so a reconstruction needs only one
+ * final division. The k weights are independent, so with a pool they are computed in
+ * parallel and the lcm is taken as a tree reduction.
+ *
+ * @throws std::runtime_error if two x-coordinates are equal.
+ */
+LagrangeWeights lagrangeWeightsAtZero(const std::vector<long long>& xs, ThreadPool* pool = nullptr) {
+    long long x_to_evaluate = 0;
+    size_t k = xs.size();
+
+    // prefix[j] = prod_{i < j} (0 - x_i) and suffix[j] = prod_{i >= j} (0 - x_i)
+    std::vector<BigInt> prefix(k + 1, 1), suffix(k + 1, 1);
+    for (size_t j = 0; j < k; j++) {
+        prefix[j + 1] = prefix[j] * (x_to_evaluate - xs[j]);
+    }
+    for (size_t j = k; j-- > 0; ) {
+        suffix[j] = suffix[j + 1] * (x_to_evaluate - xs[j]);
+    }
+
+    std::vector<BigInt> numerators(k), denominators(k);
+    parallelFor(pool, k, [&](size_t j) { // for each point j
+        // Calculate the Lagrange basis polynomial L_j(0)
+        BigInt term_numerator = prefix[j] * suffix[j + 1];
+        BigInt term_denominator = basisDenominator(xs, j);
+
+        if (term_denominator == 0) {
+            throw std::runtime_error("Division by zero in Lagrange basis. Check for duplicate x-coordinates.");
+        }
+        if (term_denominator < 0) { // keep denominators positive so the lcm is too
+            term_denominator = -term_denominator;
+            term_numerator = -term_numerator;
+        }
+
+        numerators[j] = std::move(term_numerator);
+        denominators[j] = std::move(term_denominator);
+    });
+
+    LagrangeWeights weights;
+    weights.xs = xs;
+    weights.denominator = reduceTree(denominators, pool, BigInt(1), [](const BigInt& a, const BigInt& b) {
+        return lcm(a, b);
+    });
+    weights.scaled.resize(k);
+    parallelFor(pool, k, [&](size_t j) {
+        weights.scaled[j] = numerators[j] * (weights.denominator / denominators[j]);
+    });
+    return weights;
+}
+
+
+/**
+ * @brief Computes the Lagrange weights at 0 over the prime field of order `prime`.
+ *
+ * All arithmetic is done modulo the prime on fixed-width Montgomery residues, and the
+ * k basis denominators are inverted together with a single modular inverse. With a pool,
+ * the O(k^2) basis products are spread across its threads.
+ *
+ * @throws std::invalid_argument if the prime is not an odd number above 2.
+ * @throws std::runtime_error if two x-coordinates are equal modulo the prime.
+ */
+LagrangeWeights lagrangeWeightsAtZero(const std::vector<long long>& x_values, const BigInt& prime,
+                                      ThreadPool* pool = nullptr) {
+    auto field_pointer = std::make_shared<const Montgomery>(prime);
+    const Montgomery& field = *field_pointer;
+    long long x_to_evaluate = 0;
+    size_t k = x_values.size();
+
+    LagrangeWeights weights;
+    weights.xs = x_values;
+    weights.field = field_pointer;
+    if (k == 0) return weights;
+
+    std::vector<Montgomery::Residue> xs, numerators(k), denominators(k);
+    for (long long x : x_values) {
+        xs.push_back(field.to_montgomery(x));
+    }
+    Montgomery::Residue x_eval = field.to_montgomery(x_to_evaluate);
+
+    parallelFor(pool, k, [&](size_t j) { // for each point j
+        Montgomery::Residue term_numerator = field.one();
+        Montgomery::Residue term_denominator = field.one();
+        Montgomery::Residue scratch; // reused by every product below
+
+        // Calculate the Lagrange basis polynomial L_j(0)
+        for (size_t i = 0; i < k; i++) {
+            if (i == j) continue;
+            field.multiply(term_numerator, term_numerator, field.subtract(x_eval, xs[i]), scratch);
+            field.multiply(term_denominator, term_denominator, field.subtract(xs[j], xs[i]), scratch);
+        }
+
+        if (field.is_zero(term_denominator)) {
+            throw std::runtime_error("Division by zero in Lagrange basis. Check for duplicate x-coordinates modulo the prime.");
+        }
+
+        numerators[j] = std::move(term_numerator);
+        denominators[j] = std::move(term_denominator);
+    });
+
+    // Invert every denominator with one modular inverse (Montgomery's trick):
+    // with prefix[j] = d_0 * ... * d_j, 1/d_j = prefix[j-1] / prefix[j].
+    std::vector<Montgomery::Residue> prefix(k);
+    prefix[0] = denominators[0];
+    for (size_t j = 1; j < k; j++) {
+        prefix[j] = field.multiply(prefix[j - 1], denominators[j]);
+    }
+    Montgomery::Residue inverse = field.inverse(prefix[k - 1]); // 1 / prefix[j], walking j down
+
+    weights.residues.resize(k);
+    for (size_t j = k; j-- > 0; ) {
+        Montgomery::Residue denominator_inverse = j > 0 ? field.multiply(inverse, prefix[j - 1]) : inverse;
+        inverse = field.multiply(inverse, denominators[j]);
+        weights.residues[j] = field.multiply(numerators[j], denominator_inverse);
+    }
+    return weights;
+}
+
+
+/**
+ * @brief Reconstructs P(0) as the dot product of the y values with precomputed weights.
+ *
+ * The products are independent, so with a pool they are computed in parallel and
+ * summed as a tree reduction.
+ *
+ * @param points The (x, y) pairs, with the x-coordinates in the order of `weights.xs`.
+ * @return The value of the polynomial at x=0 (in [0, prime) over a prime field).
+ * @throws std::runtime_error if, over the integers, P(0) is not an integer.
+ */
+BigInt interpolateWithWeights(const LagrangeWeights& weights, const std::vector<std::pair<long long, BigInt>>& points,
+                              ThreadPool* pool = nullptr) {
+    size_t k = points.size();
+    if (weights.field) {
+        const Montgomery& field = *weights.field;
+        std::vector<Montgomery::Residue> terms(k);
+        parallelFor(pool, k, [&](size_t j) {
+            terms[j] = field.multiply(field.to_montgomery(points[j].second), weights.residues[j]);
+        });
+        Montgomery::Residue final_result = reduceTree(std::move(terms), pool, field.to_montgomery(0),
+            [&](const Montgomery::Residue& a, const Montgomery::Residue& b) { return field.add(a, b); });
+        return field.from_montgomery(final_result);
+    }
+
+    std::vector<BigInt> terms(k);
+    parallelFor(pool, k, [&](size_t j) {
+        terms[j] = points[j].second * weights.scaled[j];
+    });
+    BigInt final_numerator = reduceTree(std::move(terms), pool, BigInt(0), [](const BigInt& a, const BigInt& b) {
+        return a + b;
+    });
+
+    BigInt final_result, remainder;
+    std::tie(final_result, remainder) = divmod(final_numerator, weights.denominator);
+    if (remainder != 0) {
+        throw std::runtime_error("P(0) = " + final_numerator.to_string() + "/" + weights.denominator.to_string()
+                                 + " is not an integer. Check the shares for corruption.");
+    }
+
+    return final_result;
+}
+
+
+std::vector<long long> xCoordinates(const std::vector<std::pair<long long, BigInt>>& points) {
+    std::vector<long long> xs;
+    for (const auto& p : points) xs.push_back(p.first);
+    return xs;
+}
+
+
+/**
+ * @brief Calculates the polynomial's constant term P(0) using Lagrange Interpolation.
+ *
+ * @param points The vector of (x, y) pairs defining the polynomial.
+ * @param pool The thread pool to spread the terms over, or null to evaluate them in order.
+ * @return The value of the polynomial at x=0.
+ * @throws std::runtime_error if two points share an x-coordinate, or if P(0) is not an integer.
+ */
+BigInt lagrange_interpolate_at_zero(const std::vector<std::pair<long long, BigInt>>& points, ThreadPool* pool = nullptr) {
+    return interpolateWithWeights(lagrangeWeightsAtZero(xCoordinates(points), pool), points, pool);
+}
+
+/**
+ * @brief Calculates P(0) over the prime field of order `prime` using Lagrange Interpolation.
+ *
+ * @param points The vector of (x, y) pairs defining the polynomial.
+ * @param prime The odd prime modulus of the field.
+ * @param pool The thread pool to spread the terms over, or null to evaluate them in order.
+ * @return The value of the polynomial at x=0, in the range [0, prime).
+ */
+BigInt lagrange_interpolate_at_zero(const std::vector<std::pair<long long, BigInt>>& points, const BigInt& prime,
+                                    ThreadPool* pool = nullptr) {
+    return interpolateWithWeights(lagrangeWeightsAtZero(xCoordinates(points), prime, pool), points, pool);
+}
+
+
+/**
+ * @brief Multiplies together the differences x_j - x_i for every i != j, in any exact integer type T.
+ *
+ * As in basisDenominator, the product is accumulated natively, here in long long, and only
+ * spills into T when the next factor would overflow.
+ */
+template <class T>
+T basisDenominatorIn(const std::vector<std::pair<long long, T>>& points, size_t j) {
+    T product = 1;
+    long long native_product = 1;
+    for (size_t i = 0; i < points.size(); i++) {
+        if (i == j) continue;
+        long long factor;
+        if (__builtin_sub_overflow(points[j].first, points[i].first, &factor)) {
+            product *= T(points[j].first) - T(points[i].first);
+            continue;
+        }
+        long long next;
+        if (__builtin_mul_overflow(native_product, factor, &next)) {
+            product *= T(native_product);
+            next = factor;
+        }
+        native_product = next;
+    }
+    return product * T(native_product);
+}
+
+/**
+ * @brief Calculates P(0) using Lagrange Interpolation in any exact integer type T.
+ *
+ * This is the generic form, for fixed-width types such as FixedBigInt that have neither
+ * the weight cache nor a Montgomery field. As over BigInt, the numerators come from prefix
+ * and suffix products, and the terms are summed over the lcm of the basis denominators, so
+ * one final division gives P(0) and checks that it is an integer.
+ *
+ * @throws std::runtime_error if two points share an x-coordinate, or if P(0) is not an integer.
+ */
+template <class T>
+T lagrange_interpolate_at_zero(const std::vector<std::pair<long long, T>>& points) {
+    size_t k = points.size();
+
+    // prefix[j] = prod_{i < j} (0 - x_i) and suffix[j] = prod_{i >= j} (0 - x_i)
+    std::vector<T> prefix(k + 1, T(1)), suffix(k + 1, T(1));
+    for (size_t j = 0; j < k; j++) {
+        prefix[j + 1] = prefix[j] * (T(0) - T(points[j].first));
+    }
+    for (size_t j = k; j-- > 0; ) {
+        suffix[j] = suffix[j + 1] * (T(0) - T(points[j].first));
+    }
+
+    std::vector<T> numerators(k), denominators(k);
+    T denominator = 1;
+    for (size_t j = 0; j < k; j++) {
+        T term_numerator = prefix[j] * suffix[j + 1];
+        T term_denominator = basisDenominatorIn(points, j);
+        if (term_denominator == 0) {
+            throw std::runtime_error("Division by zero in Lagrange basis. Check for duplicate x-coordinates.");
+        }
+        if (term_denominator < 0) { // keep denominators positive so the lcm is too
+            term_denominator = T(0) - term_denominator;
+            term_numerator = T(0) - term_numerator;
+        }
+        denominator = denominator / gcd(denominator, term_denominator) * term_denominator;
+        numerators[j] = term_numerator;
+        denominators[j] = term_denominator;
+    }
+
+    T numerator = 0;
+    for (size_t j = 0; j < k; j++) {
+        numerator += points[j].second * (numerators[j] * (denominator / denominators[j]));
+    }
+    if (numerator % denominator != 0) {
+        throw std::runtime_error("P(0) = " + numerator.to_string() + "/" + denominator.to_string()
+                                 + " is not an integer. Check the shares for corruption.");
+    }
+    return numerator / denominator;
+}
+
+/**
+ * @brief Calculates P(0) over the prime field of order `prime` in any exact integer type T.
+ *
+ * The numerators come from prefix and suffix products, and the terms are summed into one
+ * fraction modulo the prime, so a single modular inverse is needed. T must hold the sum of
+ * two products of residues, i.e. values up to 2 * prime^2.
+ *
+ * @return The value of the polynomial at x=0, in the range [0, prime).
+ * @throws std::runtime_error if two x-coordinates are equal modulo the prime.
+ */
+template <class T>
+T lagrange_interpolate_at_zero(const std::vector<std::pair<long long, T>>& points, const T& prime) {
+    auto reduce = [&](const T& value) {
+        T residue = value % prime;
+        return residue < 0 ? residue + prime : residue;
+    };
+
+    size_t k = points.size();
+    std::vector<T> xs;
+    for (const auto& point : points) xs.push_back(reduce(T(point.first)));
+
+    // prefix[j] = prod_{i < j} (0 - x_i) and suffix[j] = prod_{i >= j} (0 - x_i), modulo the prime
+    std::vector<T> prefix(k + 1, T(1)), suffix(k + 1, T(1));
+    for (size_t j = 0; j < k; j++) {
+        prefix[j + 1] = prefix[j] * (xs[j] == 0 ? T(0) : prime - xs[j]) % prime;
+    }
+    for (size_t j = k; j-- > 0; ) {
+        suffix[j] = suffix[j + 1] * (xs[j] == 0 ? T(0) : prime - xs[j]) % prime;
+    }
+
+    T numerator = 0, denominator = 1;
+    for (size_t j = 0; j < k; j++) {
+        T term_numerator = reduce(points[j].second) * (prefix[j] * suffix[j + 1] % prime) % prime;
+        T term_denominator = 1;
+        for (size_t i = 0; i < k; i++) {
+            if (i == j) continue;
+            T difference = xs[j] < xs[i] ? xs[j] + prime - xs[i] : xs[j] - xs[i];
+            term_denominator = term_denominator * difference % prime;
+        }
+        if (term_denominator == 0) {
+            throw std::runtime_error("Division by zero in Lagrange basis. Check for duplicate x-coordinates modulo the prime.");
+        }
+
+        numerator = (numerator * term_denominator + term_numerator * denominator) % prime;
+        denominator = denominator * term_denominator % prime;
+    }
+    return numerator * mod_inverse(denominator, prime) % prime;
+}
+
+
+// the width of the --fixed-width arithmetic
+const size_t FIXED_WIDTH_BITS = 512;
+
+/**
+ * @brief Interpolates in heap-free FixedBigInt<Bits> arithmetic instead of BigInt (--fixed-width).
+ *
+ * Over the integers the generic interpolation keeps one fraction that grows with the number
+ * of points, so this suits few points and short secrets; over a prime field every value stays
+ * below 2 * prime^2, which must fit in Bits bits.
+ *
+ * @param prime The field order, or 0 to interpolate over the integers.
+ * @throws std::overflow_error if a share, the prime or an intermediate value does not fit in Bits bits.
+ */
+template <size_t Bits>
+BigInt interpolateInFixedWidth(const std::vector<std::pair<long long, BigInt>>& points, const BigInt& prime) {
+    typedef FixedBigInt<Bits> Fixed;
+    std::vector<std::pair<long long, Fixed>> fixed_points;
+    for (const auto& point : points) {
+        fixed_points.push_back({point.first, Fixed::from_big_int(point.second)});
+    }
+    if (prime == 0) return lagrange_interpolate_at_zero(fixed_points).to_big_int();
+    return lagrange_interpolate_at_zero(fixed_points, Fixed::from_big_int(prime)).to_big_int();
+}
+
+
+// the most x-sets whose weights a server keeps; a client can send any number of distinct ones
+const size_t SERVER_WEIGHT_CACHE_ENTRIES = 256;
+
+/**
+ * @brief A thread-safe cache of Lagrange weights, keyed by the x-coordinates and the field.
+ *
+ * In batch mode every file with the same share holders reuses one set of weights, so
+ * after the first file each secret costs only k multiplications. With a capacity, the
+ * least recently used weights are dropped once it is exceeded; jobs still using them
+ * keep their copy alive.
+ */
+class LagrangeWeightCache {
+public:
+    /**
+     * @param capacity The most x-sets to keep weights for, or 0 for no limit.
+     */
+    explicit LagrangeWeightCache(size_t capacity = 0) : capacity(capacity) {}
+
+    /**
+     * @param prime The field order, or 0 for weights over the integers.
+     */
+    std::shared_ptr<const LagrangeWeights> get(const std::vector<long long>& xs, const BigInt& prime,
+                                               ThreadPool* pool = nullptr) {
+        Key key(xs, prime.to_string());
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto entry = entries.find(key);
+            if (entry != entries.end()) {
+                recency.splice(recency.begin(), recency, entry->second.position);
+                return entry->second.weights;
+            }
+        }
+        // computed outside the lock; if two threads race, both results are equal and one is kept
+        auto weights = std::make_shared<const LagrangeWeights>(
+            prime != 0 ? lagrangeWeightsAtZero(xs, prime, pool) : lagrangeWeightsAtZero(xs, pool));
+        std::lock_guard<std::mutex> lock(mutex);
+        auto [entry, inserted] = entries.emplace(std::move(key), Entry{weights, {}});
+        if (!inserted) return entry->second.weights;
+        entry->second.position = recency.insert(recency.begin(), &entry->first);
+        if (capacity > 0 && entries.size() > capacity) {
+            entries.erase(*recency.back());
+            recency.pop_back();
+        }
+        return weights;
+    }
+
+private:
+    typedef std::pair<std::vector<long long>, std::string> Key;
+    struct Entry {
+        std::shared_ptr<const LagrangeWeights> weights;
+        std::list<const Key*>::iterator position; // in `recency`
+    };
+
+    const size_t capacity;
+    std::mutex mutex;
+    std::map<Key, Entry> entries;
+    std::list<const Key*> recency; // the keys of `entries`, most recently used first
+};
+
+
+const char MERSENNE_127[] = "170141183460469231731687303715884105727"; // 2^127 - 1, prime and wider than any key difference
+
+
+/**
+ * @brief Arithmetic modulo the Mersenne prime 2^61 - 1 on native integers.
+ *
+ * Integer shares are checked through this field: shares of a polynomial with integer
+ * coefficients are also shares of that polynomial reduced modulo the prime, so its
+ * consistency can be tested without any big-number arithmetic. Keys that differ by a
+ * multiple of the prime are the same point here, so such shares are checked modulo
+ * MERSENNE_127 instead.
+ */
+struct Mersenne61Field {
+    typedef uint64_t Element;
+    static constexpr uint64_t MODULUS = (1ULL << 61) - 1;
+
+    Element reduce(unsigned __int128 value) const {
+        uint64_t folded = (uint64_t)(value & MODULUS) + (uint64_t)(value >> 61);
+        folded = (folded & MODULUS) + (folded >> 61);
+        return folded >= MODULUS ? folded - MODULUS : folded;
+    }
+
+    Element from(long long value) const {
+        long long remainder = value % (long long)MODULUS;
+        return remainder < 0 ? remainder + MODULUS : remainder;
+    }
+    Element from(const BigInt& value) const {
+        long long remainder = (value % (long long)MODULUS).to_long_long(); // in (-MODULUS, MODULUS)
+        return remainder < 0 ? remainder + MODULUS : remainder;
+    }
+
+    Element zero() const { return 0; }
+    Element one() const { return 1; }
+    bool is_zero(Element a) const { return a == 0; }
+    bool equal(Element a, Element b) const { return a == b; }
+    Element add(Element a, Element b) const { return a + b >= MODULUS ? a + b - MODULUS : a + b; }
+    Element subtract(Element a, Element b) const { return a >= b ? a - b : a + MODULUS - b; }
+    Element multiply(Element a, Element b) const { return reduce((unsigned __int128)a * b); }
+
+    Element inverse(Element a) const { // a^(p-2)
+        Element result = 1;
+        for (uint64_t exponent = MODULUS - 2; exponent > 0; exponent >>= 1) {
+            if (exponent & 1) result = multiply(result, a);
+            a = multiply(a, a);
+        }
+        return result;
+    }
+};
+
+
+/**
+ * @brief The prime field of a Montgomery context, with the interface of Mersenne61Field.
+ */
+struct MontgomeryField {
+    typedef Montgomery::Residue Element;
+    const Montgomery& field;
+
+    Element from(long long value) const { return field.to_montgomery(value); }
+    Element from(const BigInt& value) const { return field.to_montgomery(value); }
+    Element zero() const { return field.to_montgomery(0); }
+    Element one() const { return field.one(); }
+    bool is_zero(const Element& a) const { return field.is_zero(a); }
+    bool equal(const Element& a, const Element& b) const { return a == b; }
+    Element add(const Element& a, const Element& b) const { return field.add(a, b); }
+    Element subtract(const Element& a, const Element& b) const { return field.subtract(a, b); }
+    Element multiply(const Element& a, const Element& b) const { return field.multiply(a, b); }
+    Element inverse(const Element& a) const { return field.inverse(a); }
+};
+
+
+/**
+ * @brief Replaces every value by its inverse using a single field inversion (Montgomery's trick).
+ *
+ * @throws std::runtime_error if a value is zero.
+ */
+template <class Field>
+void invertAll(const Field& F, std::vector<typename Field::Element>& values) {
+    if (values.empty()) return;
+    std::vector<typename Field::Element> prefix(values.size());
+    prefix[0] = values[0];
+    for (size_t i = 1; i < values.size(); i++) prefix[i] = F.multiply(prefix[i - 1], values[i]);
+    if (F.is_zero(prefix.back())) {
+        throw std::runtime_error("Division by zero while verifying shares. Check for duplicate x-coordinates.");
+    }
+    typename Field::Element inverse = F.inverse(prefix.back()); // 1 / prefix[i], walking i down
+    for (size_t i = values.size(); i-- > 0; ) {
+        typename Field::Element value_inverse = i > 0 ? F.multiply(inverse, prefix[i - 1]) : inverse;
+        inverse = F.multiply(inverse, values[i]);
+        values[i] = value_inverse;
+    }
+}
+
+
+/**
+ * @brief Evaluates a polynomial, given by its coefficients from the constant term up, at x.
+ */
+template <class Field>
+typename Field::Element evaluatePolynomial(const Field& F, const std::vector<typename Field::Element>& coefficients,
+                                           const typename Field::Element& x) {
+    typename Field::Element result = F.zero();
+    for (size_t i = coefficients.size(); i-- > 0; ) result = F.add(F.multiply(result, x), coefficients[i]);
+    return result;
+}
+
+
+/**
+ * @brief Checks whether the shares beyond the first k lie on the polynomial through the first k.
+ *
+ * The first k shares are put into Newton form, with each level of divided differences
+ * inverted in one batch, and the Newton form is evaluated at every other share:
+ * O(nk) multiplications and k inversions in all.
+ */
+template <class Field>
+bool sharesAreConsistent(const Field& F, const std::vector<typename Field::Element>& xs,
+                         const std::vector<typename Field::Element>& ys, size_t k) {
+    typedef typename Field::Element Element;
+    size_t n = xs.size();
+    if (n <= k) return true;
+
+    // divided[i] holds f[x_{i-level}, ..., x_i] after each level; the diagonal is the Newton form
+    std::vector<Element> divided(ys.begin(), ys.begin() + k);
+    for (size_t level = 1; level < k; level++) {
+        std::vector<Element> gaps;
+        for (size_t i = level; i < k; i++) gaps.push_back(F.subtract(xs[i], xs[i - level]));
+        invertAll(F, gaps);
+        for (size_t i = k; i-- > level; ) {
+            divided[i] = F.multiply(F.subtract(divided[i], divided[i - 1]), gaps[i - level]);
+        }
+    }
+
+    for (size_t j = k; j < n; j++) {
+        Element value = F.zero();
+        for (size_t i = k; i-- > 0; ) value = F.add(F.multiply(value, F.subtract(xs[j], xs[i])), divided[i]);
+        if (!F.equal(value, ys[j])) return false;
+    }
+    return true;
+}
+
+
+/**
+ * @brief Finds the shares that do not lie on the degree < k polynomial through the others.
+ *
+ * When the extra shares agree with the first k, no share is corrupted and the check cost
+ * O(nk). Otherwise a Berlekamp-Welch decoder corrects up to e = (n - k) / 2 errors: it
+ * solves Q(x_i) = y_i E(x_i) for Q of degree < k + e and a monic error locator E of
+ * degree e by Gaussian elimination, recovers P = Q / E, and reports every share where P
+ * disagrees. This is O(n^3) field operations, against C(n, k) interpolations for a
+ * subset search.
+ *
+ * @return The indices of the corrupted shares, in increasing order.
+ * @throws std::runtime_error if the shares cannot be decoded, i.e. more than e are corrupted.
+ */
+template <class Field>
+std::vector<size_t> findCorruptShares(const Field& F, const std::vector<std::pair<long long, BigInt>>& points, size_t k) {
+    typedef typename Field::Element Element;
+    size_t n = points.size();
+    std::vector<Element> xs, ys;
+    for (const auto& p : points) {
+        xs.push_back(F.from(p.first));
+        ys.push_back(F.from(p.second));
+    }
+    if (sharesAreConsistent(F, xs, ys, k)) return {};
+
+    size_t e = (n - k) / 2;
+    std::string too_many = "The shares are inconsistent, and more than " + std::to_string(e) + " of the "
+                           + std::to_string(n) + " are corrupted, so they cannot be corrected.";
+    if (e == 0) {
+        throw std::runtime_error("The shares are inconsistent, but " + std::to_string(n - k)
+                                 + " extra share(s) are too few to tell which are corrupted.");
+    }
+
+    // Unknowns: q_0 .. q_{k+e-1}, then e_0 .. e_{e-1}; row i reads
+    // sum_j q_j x_i^j - y_i sum_j e_j x_i^j = y_i x_i^e
+    size_t unknowns = k + 2 * e;
+    std::vector<std::vector<Element>> rows(n, std::vector<Element>(unknowns + 1));
+    for (size_t i = 0; i < n; i++) {
+        Element power = F.one();
+        for (size_t j = 0; j < k + e; j++) {
+            rows[i][j] = power;
+            if (j < e) rows[i][k + e + j] = F.subtract(F.zero(), F.multiply(ys[i], power));
+            if (j == e) rows[i][unknowns] = F.multiply(ys[i], power);
+            power = F.multiply(power, xs[i]);
+        }
+    }
+
+    // Reduce to reduced row echelon form; free unknowns are left at zero
+    std::vector<size_t> pivot_columns;
+    size_t rank = 0;
+    for (size_t column = 0; column < unknowns && rank < n; column++) {
+        size_t pivot = rank;
+        while (pivot < n && F.is_zero(rows[pivot][column])) pivot++;
+        if (pivot == n) continue;
+        std::swap(rows[rank], rows[pivot]);
+        Element scale = F.inverse(rows[rank][column]);
+        for (size_t j = column; j <= unknowns; j++) rows[rank][j] = F.multiply(rows[rank][j], scale);
+        for (size_t i = 0; i < n; i++) {
+            if (i == rank || F.is_zero(rows[i][column])) continue;
+            Element factor = rows[i][column];
+            for (size_t j = column; j <= unknowns; j++) {
+                rows[i][j] = F.subtract(rows[i][j], F.multiply(factor, rows[rank][j]));
+            }
+        }
+        pivot_columns.push_back(column);
+        rank++;
+    }
+    for (size_t i = rank; i < n; i++) {
+        if (!F.is_zero(rows[i][unknowns])) throw std::runtime_error(too_many);
+    }
+    std::vector<Element> solution(unknowns, F.zero());
+    for (size_t r = 0; r < rank; r++) solution[pivot_columns[r]] = rows[r][unknowns];
+
+    // P = Q / E, where E = x^e + e_{e-1} x^(e-1) + ... + e_0 is monic
+    std::vector<Element> remainder(solution.begin(), solution.begin() + k + e);
+    std::vector<Element> locator(solution.begin() + k + e, solution.end());
+    locator.push_back(F.one());
+    std::vector<Element> quotient(k);
+    for (size_t d = k; d-- > 0; ) {
+        Element lead = remainder[d + e];
+        quotient[d] = lead;
+        for (size_t j = 0; j <= e; j++) remainder[d + j] = F.subtract(remainder[d + j], F.multiply(lead, locator[j]));
+    }
+    for (size_t j = 0; j < e; j++) {
+        if (!F.is_zero(remainder[j])) throw std::runtime_error(too_many);
+    }
+
+    std::vector<size_t> corrupt;
+    for (size_t i = 0; i < n; i++) {
+        if (!F.equal(evaluatePolynomial(F, quotient, xs[i]), ys[i])) corrupt.push_back(i);
+    }
+    if (corrupt.size() > e) throw std::runtime_error(too_many);
+    return corrupt;
+}
+
+
+/**
+ * @brief Tells whether two shares have keys that are congruent modulo the given modulus.
+ *
+ * Such keys are the same point of the field findCorruptShares works in, which leaves it
+ * a zero denominator.
+ */
+bool keysCollide(const std::vector<std::pair<long long, BigInt>>& points, const BigInt& modulus) {
+    std::vector<BigInt> residues;
+    residues.reserve(points.size());
+    for (const auto& p : points) {
+        BigInt residue = BigInt(p.first) % modulus;
+        if (residue < 0) residue += modulus;
+        residues.push_back(std::move(residue));
+    }
+    std::sort(residues.begin(), residues.end());
+    return std::adjacent_find(residues.begin(), residues.end()) != residues.end();
+}
+
+
+/**
+ * @brief Confirms over the integers that the shares findCorruptShares kept lie on one polynomial.
+ *
+ * The decoder works modulo a prime, so it cannot see a share that is off by a multiple of
+ * it. An Interpolator is started on the first k shares, the corrupted ones among them are
+ * removed and the next kept shares take their place; every later kept share must then
+ * match the polynomial exactly.
+ *
+ * @throws std::runtime_error if a kept share is not on the polynomial through the others.
+ */
+void confirmShares(const std::vector<std::pair<long long, BigInt>>& points, const std::vector<size_t>& corrupt, size_t k) {
+    if (points.size() - corrupt.size() <= k) return; // any k shares lie on one polynomial
+    std::vector<bool> excluded(points.size(), false);
+    for (size_t i : corrupt) excluded[i] = true;
+
+    Interpolator interpolator;
+    for (size_t i = 0; i < k; i++) interpolator.add_point(points[i].first, points[i].second);
+    for (size_t i : corrupt) {
+        if (i < k) interpolator.remove_point(points[i].first);
+    }
+    for (size_t i = k; i < points.size(); i++) {
+        if (excluded[i]) continue;
+        if (interpolator.size() < k) {
+            interpolator.add_point(points[i].first, points[i].second);
+            continue;
+        }
+        bool matches;
+        try {
+            matches = interpolator.evaluate(points[i].first) == points[i].second;
+        } catch (std::runtime_error&) { // P(x) is not even an integer
+            matches = false;
+        }
+        if (!matches) {
+            throw std::runtime_error("The share at x = " + std::to_string(points[i].first)
+                                     + " agrees with the others modulo the check prime but not over the integers.");
+        }
+    }
+}
+
+
+/**
+ * @brief Settings shared by every file processed in one run.
+ */
+struct SolverOptions {
+    BigInt prime = 0; // when non-zero, interpolate over the field of this order by default
+    size_t jobs = 1;  // worker threads for the files and their interpolation; 0 means one per hardware thread
+    bool mmap_input = false; // read the files through a memory mapping instead of a stream
+    bool verify = false;     // check every share and exclude the corrupted ones before reconstructing
+    bool fixed_width = false; // interpolate in FixedBigInt<FIXED_WIDTH_BITS> instead of BigInt
+    bool profile = false;    // report the time of each phase, and the peak memory and BigInt operations of the run
+    LagrangeWeightCache* weight_cache = nullptr; // in batch mode, reuse weights across files with the same x-set
+    size_t weight_cache_entries = 0; // the most x-sets the weight cache keeps; 0 means no limit
+    bool inline_jobs_only = false; // in server mode, refuse jobs that name a file
+};
+
+
+/**
+ * @brief A read-only memory mapping of a whole file.
+ *
+ * Where mmap is unavailable (Windows), the file is read into memory instead, so
+ * callers see the same view either way.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const char* filename) {
+#ifndef _WIN32
+        int fd = open(filename, O_RDONLY);
+        if (fd < 0) return;
+        struct stat info;
+        if (fstat(fd, &info) == 0) {
+            opened = true;
+            size = info.st_size;
+            if (size > 0) {
+                void* mapping = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+                if (mapping == MAP_FAILED) {
+                    opened = false;
+                    size = 0;
+                } else {
+                    data = static_cast<const char*>(mapping);
+                    madvise(mapping, size, MADV_SEQUENTIAL);
+                }
+            }
+        }
+        close(fd);
+#else
+        std::ifstream file(filename, std::ios::binary);
+        if (!file.is_open()) return;
+        contents.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+        opened = true;
+        data = contents.data();
+        size = contents.size();
+#endif
+    }
+
+    ~MappedFile() {
+#ifndef _WIN32
+        if (data != nullptr) munmap(const_cast<char*>(data), size);
+#endif
+    }
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool is_open() const { return opened; }
+    std::string_view view() const { return std::string_view(data, size); }
+
+private:
+    bool opened = false;
+    const char* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    std::string contents;
+#endif
+};
+
+
+/**
+ * @brief Wall times of the phases of processing one file, for --profile.
+ *
+ * Each mark() ends a phase, which began at the previous mark (or at construction).
+ */
+class PhaseProfile {
+public:
+    void mark(const char* phase) {
+        Clock::time_point now = Clock::now();
+        phases.push_back({phase, std::chrono::duration<double>(now - last).count()});
+        last = now;
+    }
+
+    void print(std::ostream& out) const {
+        std::ostringstream report;
+        report << std::fixed << std::setprecision(3) << "Profile:" << std::endl;
+        double total = 0;
+        for (const auto& phase : phases) {
+            report << "  " << phase.first << ": " << phase.second * 1e3 << " ms" << std::endl;
+            total += phase.second;
+        }
+        report << "  total: " << total * 1e3 << " ms" << std::endl;
+        out << report.str();
+    }
+
+private:
+    using Clock = std::chrono::steady_clock;
+    Clock::time_point last = Clock::now();
+    std::vector<std::pair<const char*, double>> phases;
+};
+
+
+/**
+ * @brief The contents of a share file.
+ */
+struct ShareFile {
+    size_t k = 0;
+    bool has_k = false;
+    std::string prime;                                    // the "prime" entry of `keys` as written, or empty
+    size_t count = 0;                                     // the number of shares in the file
+    std::vector<std::pair<long long, BigInt>> points;     // the k shares with the smallest x, sorted by x
+};
+
+
+/**
+ * @brief SAX handler that selects the shares of a file while it is being parsed.
+ *
+ * The file is never held as a JSON tree. Shares are kept as raw digit strings, and only
+ * their cheap integer x-coordinates are compared: whenever more than 2k are buffered,
+ * nth_element trims them back to the k smallest. So at most 2k raw values are held, and
+ * finish() converts only the k selected values to BigInts. Entries the solver does not
+ * use are skipped.
+ */
+class ShareFileReader : public nlohmann::json_sax<json> {
+public:
+    /**
+     * @param all_shares Keep and decode every share rather than only the k with the smallest x.
+     */
+    explicit ShareFileReader(ShareFile& shares, bool all_shares = false) : shares(shares), all_shares(all_shares) {}
+
+    std::string error; // the parse error, if sax_parse returned false
+    PhaseProfile* profile = nullptr; // when set, finish() marks its "sort" and "convert" phases
+
+    bool null() override { return true; }
+    bool boolean(bool) override { return true; }
+    bool number_integer(number_integer_t val) override { return scalar(std::to_string(val)); }
+    bool number_unsigned(number_unsigned_t val) override { return scalar(std::to_string(val)); }
+    bool number_float(number_float_t, const string_t& text) override { return scalar(text); }
+    bool string(string_t& val) override { return scalar(std::move(val)); }
+    bool binary(binary_t&) override { return true; }
+    bool start_array(std::size_t) override {
+        depth++;
+        if (depth == 2) in_entry = false;
+        return true;
+    }
+    bool end_array() override { depth--; return true; }
+
+    bool start_object(std::size_t) override {
+        depth++;
+        if (depth == 2) {
+            in_entry = true;
+            startEntry(entry);
+        }
+        return true;
+    }
+
+    bool key(string_t& val) override {
+        if (depth == 1) entry = std::move(val);
+        else if (depth == 2) field = std::move(val);
+        return true;
+    }
+
+    bool end_object() override {
+        if (depth == 2) endEntry();
+        depth--;
+        return true;
+    }
+
+    bool parse_error(std::size_t, const std::string&, const nlohmann::detail::exception& ex) override {
+        error = ex.what();
+        return false;
+    }
+
+    /*
+     * The entry calls below are what the SAX callbacks reduce to. ShareScanner makes them
+     * directly, without the SAX parser, for each object that is the value of a top-level key.
+     */
+
+    /**
+     * @brief Starts the object under the top-level key `name`: the keys block or a share.
+     */
+    void startEntry(const std::string& name) {
+        entry = name;
+        in_keys = entry == "keys";
+        base.clear();
+        value.clear();
+        mapped_value = std::string_view();
+    }
+
+    /**
+     * @brief Records a scalar field of the current entry, given as its text.
+     */
+    void entryField(const std::string& name, std::string text) {
+        if (in_keys) {
+            if (name == "k") {
+                shares.k = std::stoull(text);
+                shares.has_k = true;
+            } else if (name == "prime") {
+                shares.prime = std::move(text);
+            }
+        } else if (name == "base") {
+            base = std::move(text);
+        } else if (name == "value") {
+            value = std::move(text);
+            mapped_value = std::string_view();
+        }
+    }
+
+    /**
+     * @brief Records a share's value as a slice of the input, which must outlive finish().
+     */
+    void mappedValue(std::string_view digits) {
+        if (in_keys) return;
+        mapped_value = digits;
+        value.clear();
+    }
+
+    /**
+     * @brief Ends the current entry; a share is then buffered, or trimmed away with the others.
+     */
+    void endEntry() {
+        if (in_keys) return;
+        if (base.empty() || (value.empty() && mapped_value.empty())) {
+            throw std::invalid_argument("share " + entry + " needs both a \"base\" and a \"value\"");
+        }
+        candidates.push_back({std::stoll(entry), std::stoi(base), std::move(value), mapped_value});
+        value = std::string();
+        shares.count++;
+        if (!all_shares && shares.has_k && candidates.size() > 2 * shares.k) keepSmallest(shares.k);
+    }
+
+    /**
+     * @brief Decodes the k shares with the smallest x-coordinates into `points`, sorted by x.
+     *
+     * @throws std::invalid_argument if a selected value has a digit that is invalid for its base.
+     */
+    void finish() {
+        if (!all_shares) keepSmallest(shares.k);
+        std::sort(candidates.begin(), candidates.end(), [](const RawShare& a, const RawShare& b) {
+            return a.x < b.x;
+        });
+        if (profile != nullptr) profile->mark("sort");
+        for (RawShare& share : candidates) {
+            shares.points.push_back({share.x, convertToBase10(share.digits(), share.base)});
+            share.owned = std::string(); // release the raw digits
+        }
+        candidates.clear();
+        if (profile != nullptr) profile->mark("convert");
+    }
+
+private:
+    struct RawShare {
+        long long x;
+        int base;
+        std::string owned;        // the digits, when they were copied out of the parser
+        std::string_view mapped;  // or else the digits as a slice of the mapped file
+
+        std::string_view digits() const { return mapped.empty() ? std::string_view(owned) : mapped; }
+    };
+
+    void keepSmallest(size_t count) {
+        if (candidates.size() <= count) return;
+        std::nth_element(candidates.begin(), candidates.begin() + count, candidates.end(),
+                         [](const RawShare& a, const RawShare& b) { return a.x < b.x; });
+        candidates.resize(count);
+    }
+
+    bool scalar(std::string text) {
+        if (depth == 2 && in_entry) entryField(field, std::move(text));
+        return true;
+    }
+
+    ShareFile& shares;
+    bool all_shares = false;
+    int depth = 0;
+    bool in_entry = false; // inside an object that is the value of a top-level key
+    bool in_keys = false;
+    std::string entry, field; // the current top-level key and the current key inside it
+    std::string base, value;
+    std::string_view mapped_value;
+    std::vector<RawShare> candidates; // the shares that may still be among the k smallest
+};
+
+
+/**
+ * @brief Streams a share file from `input` with json::sax_parse, without building a JSON tree.
+ *
+ * Only the k shares with the smallest x-coordinates are decoded (see ShareFileReader),
+ * unless `all_shares` is set.
+ *
+ * @param profile When set, receives the "parse", "sort" and "convert" phases.
+ *
+ * @return False with `error` set if the input is not valid JSON.
+ * @throws std::invalid_argument if a share's key or base, or a selected value, is malformed.
+ */
+bool loadShares(std::istream& input, ShareFile& shares, std::string& error, bool all_shares = false,
+                PhaseProfile* profile = nullptr) {
+    ShareFileReader reader(shares, all_shares);
+    reader.profile = profile;
+    if (!json::sax_parse(input, &reader)) {
+        error = reader.error;
+        return false;
+    }
+    if (profile != nullptr) profile->mark("parse");
+    if (shares.has_k) reader.finish();
+    return true;
+}
+
+/**
+ * @brief Reads a share file held in memory straight into a ShareFileReader, without the JSON lexer.
+ *
+ * Each share's digits are handed to the reader as a slice of the input, so they are read
+ * once here and once when decoded, and never copied. The scanner follows the JSON grammar
+ * but gives up on what share files do not use: escapes, non-ASCII text, nesting deeper than
+ * MAX_DEPTH and any syntax error. The caller then parses the input with json::sax_parse,
+ * which handles all of JSON and reports the errors.
+ */
+class ShareScanner {
+public:
+    ShareScanner(std::string_view text, ShareFileReader& reader) : text(text), reader(reader) {}
+
+    /**
+     * @return False if the input needs the full JSON parser.
+     * @throws std::invalid_argument if a share's key or base is malformed, as the reader does.
+     */
+    bool scan() {
+        skipWhitespace();
+        if (!consume('{')) return false;
+        skipWhitespace();
+        if (!consume('}')) {
+            do {
+                std::string_view name;
+                if (!readKey(name)) return false;
+                if (peek() == '{' ? !readEntry(std::string(name)) : !skipValue(1)) return false;
+                skipWhitespace();
+            } while (consume(','));
+            if (!consume('}')) return false;
+        }
+        skipWhitespace();
+        return position == text.size();
+    }
+
+private:
+    static const int MAX_DEPTH = 64;
+
+    /**
+     * @brief Reads the object under a top-level key: the keys block or a share.
+     */
+    bool readEntry(const std::string& name) {
+        consume('{');
+        reader.startEntry(name);
+        skipWhitespace();
+        if (!consume('}')) {
+            do {
+                std::string_view field, scalar;
+                if (!readKey(field)) return false;
+                if (peek() == '"') {
+                    if (!readString(scalar)) return false;
+                    if (field == "value") reader.mappedValue(scalar);
+                    else reader.entryField(std::string(field), std::string(scalar));
+                } else if (peek() == '-' || isDigit(peek())) {
+                    if (!readNumber(scalar)) return false;
+                    reader.entryField(std::string(field), std::string(scalar));
+                } else if (!skipValue(2)) { // nested values and literals carry nothing the reader needs
+                    return false;
+                }
+                skipWhitespace();
+            } while (consume(','));
+            if (!consume('}')) return false;
+        }
+        reader.endEntry();
+        return true;
+    }
+
+    bool skipValue(int depth) {
+        std::string_view skipped;
+        skipWhitespace();
+        switch (peek()) {
+        case '"':
+            return readString(skipped);
+        case '{':
+        case '[': {
+            char close = text[position] == '{' ? '}' : ']';
+            if (depth >= MAX_DEPTH) return false;
+            position++;
+            skipWhitespace();
+            if (consume(close)) return true;
+            do {
+                if (close == '}' && !readKey(skipped)) return false;
+                if (!skipValue(depth + 1)) return false;
+                skipWhitespace();
+            } while (consume(','));
+            return consume(close);
+        }
+        case 't':
+            return consumeWord("true");
+        case 'f':
+            return consumeWord("false");
+        case 'n':
+            return consumeWord("null");
+        default:
+            return readNumber(skipped);
+        }
+    }
+
+    /**
+     * @brief Reads a member name and its colon, leaving the position at the value.
+     */
+    bool readKey(std::string_view& name) {
+        skipWhitespace();
+        if (!readString(name)) return false;
+        skipWhitespace();
+        if (!consume(':')) return false;
+        skipWhitespace();
+        return true;
+    }
+
+    bool readString(std::string_view& contents) {
+        if (!consume('"')) return false;
+        size_t start = position;
+        for (; position < text.size(); position++) {
+            unsigned char c = text[position];
+            if (c == '"') {
+                contents = text.substr(start, position++ - start);
+                return true;
+            }
+            if (c == '\\' || c < 0x20 || c >= 0x80) return false; // escapes, control characters, UTF-8
+        }
+        return false;
+    }
+
+    /**
+     * @brief Reads a number by the JSON grammar: -?(0|[1-9][0-9]*)(.[0-9]+)?([eE][+-]?[0-9]+)?
+     */
+    bool readNumber(std::string_view& number) {
+        size_t start = position;
+        consume('-');
+        if (consume('0')) {
+            if (isDigit(peek())) return false;
+        } else if (!skipDigits()) {
+            return false;
+        }
+        if (consume('.') && !skipDigits()) return false;
+        if (consume('e') || consume('E')) {
+            if (!consume('+')) consume('-');
+            if (!skipDigits()) return false;
+        }
+        number = text.substr(start, position - start);
+        return true;
+    }
+
+    bool skipDigits() {
+        size_t start = position;
+        while (isDigit(peek())) position++;
+        return position > start;
+    }
+
+    void skipWhitespace() {
+        while (position < text.size()
+               && (text[position] == ' ' || text[position] == '\n' || text[position] == '\r' || text[position] == '\t')) {
+            position++;
+        }
+    }
+
+    bool consumeWord(std::string_view word) {
+        if (text.substr(position, word.size()) != word) return false;
+        position += word.size();
+        return true;
+    }
+
+    bool consume(char c) {
+        if (peek() != c) return false;
+        position++;
+        return true;
+    }
+
+    char peek() const { return position < text.size() ? text[position] : '\0'; }
+    static bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+    std::string_view text;
+    size_t position = 0;
+    ShareFileReader& reader;
+};
+
+/**
+ * @brief Parses a share file held in memory, such as a MappedFile or a server job.
+ *
+ * ShareScanner reads the common case, leaving the digits of each share in `mapping` until
+ * they are decoded, so `mapping` only has to outlive this call. Anything it does not handle
+ * is parsed with json::sax_parse instead, with the same result.
  */
-BigInt convertToBase10(const std::string& numStr, int base) {
-    BigInt result = 0;
-    BigInt power = 1;
-    BigInt big_base = base;
+bool loadShares(std::string_view mapping, ShareFile& shares, std::string& error, bool all_shares = false,
+                PhaseProfile* profile = nullptr) {
+    {
+        ShareFileReader reader(shares, all_shares);
+        reader.profile = profile;
+        if (ShareScanner(mapping, reader).scan()) {
+            if (profile != nullptr) profile->mark("parse");
+            if (shares.has_k) reader.finish();
+            return true;
+        }
+    }
+
+    shares = ShareFile(); // drop what the scanner read before it gave up
+    ShareFileReader reader(shares, all_shares);
+    reader.profile = profile;
+    if (!json::sax_parse(mapping.data(), mapping.data() + mapping.size(), &reader)) {
+        error = reader.error;
+        return false;
+    }
+    if (profile != nullptr) profile->mark("parse");
+    if (shares.has_k) reader.finish();
+    return true;
+}
+
+
+/*
+ * Binary share files skip text decoding entirely. All integers are little-endian:
+ *
+ *   "SHRB"  u32 version  u64 n  u64 k  number prime   (a prime of zero means none)
+ *   then n times:  i64 x  number y
+ *
+ * where a number is  u8 sign (1 if negative)  u64 limb count  limbs (u64 each, least significant first).
+ */
+const char BINARY_SHARES_MAGIC[4] = {'S', 'H', 'R', 'B'};
+const uint32_t BINARY_SHARES_VERSION = 1;
+
+void appendLittleEndian(std::string& out, uint64_t value, int bytes = 8) {
+    for (int i = 0; i < bytes; i++) out += (char)(value >> (8 * i));
+}
+
+uint64_t readLittleEndian(const char* data, int bytes = 8) {
+    uint64_t value = 0;
+    for (int i = bytes; i-- > 0; ) value = value << 8 | (unsigned char)data[i];
+    return value;
+}
+
+void appendBinaryNumber(std::string& out, const BigInt& num) {
+    std::vector<uint64_t> limbs = num.to_limbs();
+    appendLittleEndian(out, num < 0, 1);
+    appendLittleEndian(out, limbs.size());
+    for (uint64_t limb : limbs) appendLittleEndian(out, limb);
+}
+
+
+/**
+ * @brief Checks for the binary share file magic and rewinds the stream.
+ */
+bool hasBinarySharesMagic(std::istream& input) {
+    char magic[4] = {};
+    bool matches = input.read(magic, 4) && std::equal(magic, magic + 4, BINARY_SHARES_MAGIC);
+    input.clear();
+    input.seekg(0);
+    return matches;
+}
+
+
+/**
+ * @brief Serializes every share in `shares` in the binary share format.
+ *
+ * @param prime The parsed `shares.prime`, or 0 if the file names none.
+ */
+std::string toBinaryShares(const ShareFile& shares, const BigInt& prime) {
+    std::string out(BINARY_SHARES_MAGIC, 4);
+    appendLittleEndian(out, BINARY_SHARES_VERSION, 4);
+    appendLittleEndian(out, shares.points.size());
+    appendLittleEndian(out, shares.k);
+    appendBinaryNumber(out, prime);
+    for (const auto& [x, y] : shares.points) {
+        appendLittleEndian(out, (uint64_t)x);
+        appendBinaryNumber(out, y);
+    }
+    return out;
+}
+
+
+/**
+ * @brief Loads a binary share file held in memory, such as a MappedFile.
+ *
+ * The records are first walked without touching the limbs, then only the k shares with
+ * the smallest x-coordinates (or, with `all_shares`, every share) have their limbs copied
+ * into BigInts.
+ *
+ * @return False with `error` set if the data is truncated or not a binary share file.
+ */
+bool loadBinaryShares(std::string_view data, ShareFile& shares, std::string& error, bool all_shares = false) {
+    struct Record {
+        long long x;
+        bool negative;
+        const char* limbs;
+        size_t count;
+    };
+    size_t position = 0;
+    // Reads one number header, leaving `position` after its limbs
+    auto readNumber = [&](Record& record) {
+        if (data.size() - position < 9) return false;
+        record.negative = data[position] != 0;
+        record.count = readLittleEndian(data.data() + position + 1);
+        position += 9;
+        if (record.count > (data.size() - position) / 8) return false;
+        record.limbs = data.data() + position;
+        position += record.count * 8;
+        return true;
+    };
+
+    if (data.size() < 24 || !std::equal(BINARY_SHARES_MAGIC, BINARY_SHARES_MAGIC + 4, data.data())) {
+        error = "not a binary share file";
+        return false;
+    }
+    uint32_t version = readLittleEndian(data.data() + 4, 4);
+    if (version != BINARY_SHARES_VERSION) {
+        error = "unsupported version " + std::to_string(version);
+        return false;
+    }
+    uint64_t n = readLittleEndian(data.data() + 8);
+    shares.k = readLittleEndian(data.data() + 16);
+    shares.has_k = true;
+    position = 24;
 
-    for (int i = numStr.length() - 1; i >= 0; i--) {
-        int digit;
-        if (numStr[i] >= '0' && numStr[i] <= '9') {
-            digit = numStr[i] - '0';
-        } else if (numStr[i] >= 'a' && numStr[i] <= 'z') {
-            digit = numStr[i] - 'a' + 10;
-        } else { // A-Z
-            digit = numStr[i] - 'A' + 10;
+    Record prime;
+    if (!readNumber(prime)) {
+        error = "truncated prime";
+        return false;
+    }
+    if (prime.count > 0) shares.prime = BigInt::from_limbs(prime.limbs, prime.count, prime.negative).to_string();
+
+    std::vector<Record> records;
+    for (uint64_t i = 0; i < n; i++) {
+        Record record;
+        if (data.size() - position < 8) {
+            error = "truncated share " + std::to_string(i);
+            return false;
         }
-        result += power * digit;
-        power *= big_base;
+        record.x = (long long)readLittleEndian(data.data() + position);
+        position += 8;
+        if (!readNumber(record)) {
+            error = "truncated share " + std::to_string(i);
+            return false;
+        }
+        records.push_back(record);
     }
-    return result;
+    shares.count = records.size();
+
+    auto by_x = [](const Record& a, const Record& b) { return a.x < b.x; };
+    if (!all_shares && records.size() > shares.k) {
+        std::nth_element(records.begin(), records.begin() + shares.k, records.end(), by_x);
+        records.resize(shares.k);
+    }
+    std::sort(records.begin(), records.end(), by_x);
+    for (const Record& record : records) {
+        shares.points.push_back({record.x, BigInt::from_limbs(record.limbs, record.count, record.negative)});
+    }
+    return true;
 }
 
+
 /**
- * @brief Calculates the polynomial's constant term P(0) using Lagrange Interpolation.
+ * @brief Converts a JSON share file to the binary share format, keeping every share.
  *
- * @param points The vector of (x, y) pairs defining the polynomial.
- * @return The value of the polynomial at x=0.
+ * @return The process exit code.
  */
-BigInt lagrange_interpolate_at_zero(const std::vector<std::pair<long long, BigInt>>& points) {
-    BigInt final_result = 0;
-    long long x_to_evaluate = 0;
+int convertFile(const char* input_name, const char* output_name) {
+    std::ifstream input(input_name);
+    if (!input.is_open()) {
+        std::cerr << "Error: Could not open file " << input_name << std::endl;
+        return 1;
+    }
+    ShareFile shares;
+    try {
+        std::string parse_error;
+        if (!loadShares(input, shares, parse_error, true)) {
+            std::cerr << "JSON parsing error: " << parse_error << std::endl;
+            return 1;
+        }
+        if (!shares.has_k) {
+            std::cerr << "Error: The keys block has no \"k\" entry." << std::endl;
+            return 1;
+        }
+    } catch (std::exception& e) {
+        std::cerr << "Error: Invalid share: " << e.what() << std::endl;
+        return 1;
+    }
+    BigInt prime = 0;
+    try {
+        if (!shares.prime.empty()) prime = BigInt(shares.prime);
+    } catch (std::exception& e) {
+        std::cerr << "Error: Invalid prime in keys: " << e.what() << std::endl;
+        return 1;
+    }
 
-    for (const auto& p_j : points) { // for each point j
-        BigInt term_numerator = p_j.second; // y_j
-        BigInt term_denominator = 1;
-        
-        // Calculate the Lagrange basis polynomial L_j(0)
-        for (const auto& p_i : points) {
-            if (p_i.first == p_j.first) continue; // Skip if i == j
-            term_numerator *= (x_to_evaluate - p_i.first);
-            term_denominator *= (p_j.first - p_i.first);
+    // serialize first, so that a failed conversion leaves no output file behind
+    std::string bytes = toBinaryShares(shares, prime);
+    std::ofstream output(output_name, std::ios::binary);
+    if (!output.write(bytes.data(), bytes.size())) {
+        std::cerr << "Error: Could not write file " << output_name << std::endl;
+        return 1;
+    }
+    std::cout << "Converted " << shares.points.size() << " shares from " << input_name << " to " << output_name << "." << std::endl;
+    return 0;
+}
+
+
+/*
+ * Benchmarks (`solver bench`). Every measurement is a JSON object such as
+ *
+ *   {"benchmark": "lagrange_interpolate_at_zero", "n": 64, "k": 16, "base": 16, "digits": 1000, "runs": 42, "mean_ns": ..., "min_ns": ...}
+ *
+ * in that order, where the keys that do not apply to a benchmark are left out, and in CSV they are left empty.
+ */
+const char* const BENCHMARK_COLUMNS[] = {"benchmark", "n", "k", "base", "digits", "runs", "mean_ns", "min_ns"};
+
+/**
+ * @brief The grid of synthetic share files to benchmark, and how long to measure each cell.
+ */
+struct BenchmarkOptions {
+    std::vector<size_t> n = {64};
+    std::vector<size_t> k = {4, 16, 64};
+    std::vector<size_t> bases = {10, 16, 36};
+    std::vector<size_t> digits = {100, 1000, 10000};
+    double min_seconds = 0.2; // run each benchmark at least once, and until this much time has passed
+    bool csv = false;
+};
+
+/**
+ * @brief Parses a comma-separated list of positive integers, such as "4,16,64".
+ *
+ * @throws std::invalid_argument or std::out_of_range if an entry is not a positive integer.
+ */
+std::vector<size_t> parseSizeList(const std::string& list) {
+    std::vector<size_t> values;
+    std::istringstream entries(list);
+    for (std::string entry; std::getline(entries, entry, ',');) {
+        size_t length;
+        values.push_back(std::stoul(entry, &length));
+        if (length != entry.size() || values.back() == 0) throw std::invalid_argument("invalid list entry " + entry);
+    }
+    if (values.empty()) throw std::invalid_argument("empty list");
+    return values;
+}
+
+/**
+ * @brief Writes a share file of the polynomial P at x = 1..n, with every value in `base`.
+ */
+std::string syntheticShareFile(const std::vector<BigInt>& coefficients, size_t n, int base) {
+    std::string file = "{\n    \"keys\": {\n        \"n\": " + std::to_string(n) + ",\n        \"k\": "
+                       + std::to_string(coefficients.size()) + "\n    }";
+    for (size_t x = 1; x <= n; x++) {
+        BigInt y = 0;
+        for (size_t j = coefficients.size(); j-- > 0; ) {
+            y = y * (long long)x + coefficients[j];
         }
-        
-        if (term_denominator == 0) {
-            throw std::runtime_error("Division by zero in Lagrange basis. Check for duplicate x-coordinates.");
+        file += ",\n    \"" + std::to_string(x) + "\": {\n        \"base\": \"" + std::to_string(base)
+                + "\",\n        \"value\": \"" + y.to_string(base) + "\"\n    }";
+    }
+    return file + "\n}\n";
+}
+
+/**
+ * @brief Runs `body` at least once, and until `min_seconds` have passed, and records the timings.
+ */
+template <class Body>
+void measure(ordered_json& result, double min_seconds, const Body& body) {
+    using Clock = std::chrono::steady_clock;
+    size_t runs = 0;
+    double total = 0, fastest = 0;
+    do {
+        Clock::time_point start = Clock::now();
+        body();
+        double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+        fastest = runs == 0 ? seconds : std::min(fastest, seconds);
+        total += seconds;
+        runs++;
+    } while (total < min_seconds);
+    result["runs"] = runs;
+    result["mean_ns"] = std::llround(total / runs * 1e9);
+    result["min_ns"] = std::llround(fastest * 1e9);
+}
+
+/**
+ * @brief Times parsing, convertToBase10 and lagrange_interpolate_at_zero on every cell of the
+ * grid, and the BigInt `*`, `/` and `%` operators and to_string in each base at every digit length.
+ */
+ordered_json runBenchmarks(const BenchmarkOptions& options) {
+    ordered_json results = ordered_json::array();
+    for (size_t digits : options.digits) {
+        BigInt a = big_random(digits), b = big_random(digits), wide = a * b + big_random(digits);
+        for (const char* name : {"multiply", "divide", "modulo"}) {
+            ordered_json result = {{"benchmark", name}, {"digits", digits}};
+            std::string_view op = name;
+            BigInt sink;
+            measure(result, options.min_seconds, [&] {
+                sink = op == "multiply" ? a * b : op == "divide" ? wide / b : wide % b;
+            });
+            results.push_back(result);
+        }
+        for (size_t base : options.bases) {
+            ordered_json result = {{"benchmark", "to_string"}, {"base", base}, {"digits", digits}};
+            std::string sink;
+            measure(result, options.min_seconds, [&] { sink = wide.to_string((int)base); });
+            results.push_back(result);
         }
-        
-        final_result += term_numerator / term_denominator;
     }
 
-    return final_result;
+    for (size_t digits : options.digits) {
+        for (size_t k : options.k) {
+            std::vector<BigInt> coefficients;
+            for (size_t j = 0; j < k; j++) coefficients.push_back(big_random(digits));
+            for (size_t n : options.n) {
+                if (n < k) continue;
+                for (size_t base : options.bases) {
+                    std::string file = syntheticShareFile(coefficients, n, (int)base);
+                    auto cellResult = [&](const char* name) {
+                        return ordered_json{{"benchmark", name}, {"n", n}, {"k", k}, {"base", base}, {"digits", digits}};
+                    };
+
+                    ShareFile shares;
+                    std::string error;
+                    ordered_json result = cellResult("loadShares");
+                    measure(result, options.min_seconds, [&] {
+                        shares = ShareFile();
+                        if (!loadShares(std::string_view(file), shares, error)) throw std::runtime_error(error);
+                    });
+                    results.push_back(result);
+
+                    // the same values as raw digit strings
+                    std::vector<std::string> values;
+                    for (const auto& point : shares.points) values.push_back(point.second.to_string((int)base));
+                    result = cellResult("convertToBase10");
+                    BigInt sink;
+                    measure(result, options.min_seconds, [&] {
+                        for (const std::string& value : values) sink = convertToBase10(value, (int)base);
+                    });
+                    results.push_back(result);
+
+                    result = cellResult("lagrange_interpolate_at_zero");
+                    measure(result, options.min_seconds, [&] {
+                        sink = lagrange_interpolate_at_zero(shares.points);
+                    });
+                    if (sink != coefficients[0]) throw std::runtime_error("interpolation returned the wrong secret");
+                    results.push_back(result);
+                }
+            }
+        }
+    }
+    return results;
+}
+
+/**
+ * @brief The `bench` command: runs the benchmarks and prints the results as JSON or CSV.
+ *
+ * @return The process exit code.
+ */
+int benchmarkCommand(int argc, char* argv[]) {
+    BenchmarkOptions options;
+    for (int i = 2; i < argc; i++) {
+        std::string arg = argv[i];
+        try {
+            if (arg == "--format" && i + 1 < argc && (std::string(argv[i + 1]) == "json" || std::string(argv[i + 1]) == "csv")) {
+                options.csv = std::string(argv[++i]) == "csv";
+            } else if (arg == "--n" && i + 1 < argc) {
+                options.n = parseSizeList(argv[++i]);
+            } else if (arg == "--k" && i + 1 < argc) {
+                options.k = parseSizeList(argv[++i]);
+            } else if (arg == "--bases" && i + 1 < argc) {
+                options.bases = parseSizeList(argv[++i]);
+                for (size_t base : options.bases) {
+                    if (base < 2 || base > 36) throw std::invalid_argument("base " + std::to_string(base));
+                }
+            } else if (arg == "--digits" && i + 1 < argc) {
+                options.digits = parseSizeList(argv[++i]);
+            } else if (arg == "--min-time" && i + 1 < argc) {
+                options.min_seconds = std::stod(argv[++i]);
+            } else {
+                std::cerr << "Usage: " << argv[0] << " bench [--format json|csv] [--n list] [--k list] [--bases list] [--digits list] [--min-time seconds]" << std::endl;
+                std::cerr << "  lists are comma-separated, e.g. --k 4,16,64; cells with k > n are skipped" << std::endl;
+                return 1;
+            }
+        } catch (std::exception&) {
+            std::cerr << "Error: Invalid value for " << arg << ": " << argv[i] << std::endl;
+            return 1;
+        }
+    }
+
+    ordered_json results;
+    try {
+        results = runBenchmarks(options);
+    } catch (std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+
+    if (!options.csv) {
+        std::cout << results.dump(2) << std::endl;
+        return 0;
+    }
+    for (const char* column : BENCHMARK_COLUMNS) std::cout << (column == BENCHMARK_COLUMNS[0] ? "" : ",") << column;
+    std::cout << std::endl;
+    for (const ordered_json& result : results) {
+        for (const char* column : BENCHMARK_COLUMNS) {
+            if (column != BENCHMARK_COLUMNS[0]) std::cout << ",";
+            if (!result.contains(column)) continue;
+            const ordered_json& value = result[column];
+            if (value.is_string()) {
+                std::cout << value.get<std::string>();
+            } else {
+                std::cout << value.dump();
+            }
+        }
+        std::cout << std::endl;
+    }
+    return 0;
 }
 
 
 /**
- * @brief Processes a single JSON file.
+ * @brief Reconstructs the secret from the shares of one file and reports it (steps 2 to 4 of processFile).
+ *
+ * @param profile The phases so far, which the remaining ones are added to.
  */
-void processFile(const char* filename) {
-    std::cout << "===== Processing file: " << filename << " =====" << std::endl;
+void solveShares(ShareFile& shares, const SolverOptions& options, std::ostream& out, std::ostream& err,
+                 ThreadPool* pool, PhaseProfile& profile) {
+    if (!shares.has_k) {
+        err << "Error: The keys block has no \"k\" entry." << std::endl << std::endl;
+        return;
+    }
+    size_t k = shares.k;
+    if (shares.count < k) {
+        err << "Error: Not enough points in file. Have " << shares.count << ", need " << k << "." << std::endl << std::endl;
+        return;
+    }
+
+    // 2. Work over the prime field if the file or command line names one
+    BigInt prime = options.prime;
+    try {
+        if (!shares.prime.empty()) prime = BigInt(shares.prime);
+    } catch (std::exception& e) {
+        err << "Error: Invalid prime in keys: " << e.what() << std::endl << std::endl;
+        return;
+    }
+
+    // 3. Optionally drop the shares that are inconsistent with the rest
+    std::vector<std::pair<long long, BigInt>>& points_for_calc = shares.points;
+    if (options.verify && k > 0) {
+        std::vector<size_t> corrupt;
+        try {
+            if (prime != 0) {
+                Montgomery field(prime);
+                if (keysCollide(points_for_calc, prime)) {
+                    throw std::runtime_error("Two shares have keys that are congruent modulo the prime. "
+                                             "Check for duplicate x-coordinates modulo the prime.");
+                }
+                corrupt = findCorruptShares(MontgomeryField{field}, points_for_calc, k);
+            } else if (keysCollide(points_for_calc, (long long)Mersenne61Field::MODULUS)) {
+                // Keys a multiple of 2^61 - 1 apart meet in that field, but no two keys are 2^127 - 1 apart
+                BigInt wide_prime(MERSENNE_127);
+                if (keysCollide(points_for_calc, wide_prime)) {
+                    throw std::runtime_error("Two shares have the same key. Check for duplicate x-coordinates.");
+                }
+                Montgomery field(wide_prime);
+                corrupt = findCorruptShares(MontgomeryField{field}, points_for_calc, k);
+            } else {
+                corrupt = findCorruptShares(Mersenne61Field(), points_for_calc, k);
+            }
+            if (prime == 0) confirmShares(points_for_calc, corrupt, k);
+        } catch (std::invalid_argument& e) {
+            err << "Error: Invalid prime: " << e.what() << std::endl << std::endl;
+            return;
+        } catch (std::runtime_error& e) {
+            err << "Error: " << e.what() << std::endl << std::endl;
+            return;
+        }
+
+        if (corrupt.empty()) {
+            out << "Verified all " << points_for_calc.size() << " shares: they are consistent." << std::endl;
+        } else {
+            out << "Excluded " << corrupt.size() << " corrupted share(s) at x =";
+            for (size_t i : corrupt) out << " " << points_for_calc[i].first;
+            out << "." << std::endl;
+            for (size_t i = corrupt.size(); i-- > 0; ) points_for_calc.erase(points_for_calc.begin() + corrupt[i]);
+        }
+        points_for_calc.resize(k); // the shares are sorted by x
+        profile.mark("verify");
+    }
 
-    std::ifstream json_file(filename);
-    if (!json_file.is_open()) {
-        std::cerr << "Error: Could not open file " << filename << std::endl << std::endl;
+    out << "Using the " << k << " points with the smallest x-values for calculation." << std::endl;
+
+    // 4. Calculate the final answer
+    BigInt final_answer;
+    try {
+        if (prime != 0) {
+            out << "Working over the prime field of order " << prime << "." << std::endl;
+        }
+        if (options.fixed_width) {
+            final_answer = interpolateInFixedWidth<FIXED_WIDTH_BITS>(points_for_calc, prime);
+        } else if (options.weight_cache != nullptr) {
+            auto weights = options.weight_cache->get(xCoordinates(points_for_calc), prime, pool);
+            final_answer = interpolateWithWeights(*weights, points_for_calc, pool);
+        } else if (prime != 0) {
+            final_answer = lagrange_interpolate_at_zero(points_for_calc, prime, pool);
+        } else {
+            final_answer = lagrange_interpolate_at_zero(points_for_calc, pool);
+        }
+    } catch (std::invalid_argument& e) {
+        err << "Error: Invalid prime: " << e.what() << std::endl << std::endl;
+        return;
+    } catch (std::overflow_error& e) {
+        err << "Error: " << e.what() << "; interpolate without --fixed-width." << std::endl << std::endl;
         return;
+    } catch (std::runtime_error& e) {
+        err << "Error: " << e.what() << std::endl << std::endl;
+        return;
+    }
+
+    profile.mark("interpolate");
+
+    out << "\n-----------------------------------------" << std::endl;
+    out << "Calculated constant term P(0) = " << final_answer << std::endl;
+    out << "-----------------------------------------" << std::endl << std::endl;
+    if (options.profile) {
+        profile.mark("output");
+        profile.print(out);
+        out << std::endl;
     }
-    json data;
+}
+
+
+/**
+ * @brief Processes a single share file, in JSON or the binary share format.
+ *
+ * @param out Receives the progress report and the answer.
+ * @param err Receives the error messages.
+ * @param pool The thread pool to evaluate the interpolation on, or null to run it on this thread.
+ */
+void processFile(const char* filename, const SolverOptions& options, std::ostream& out, std::ostream& err,
+                 ThreadPool* pool = nullptr) {
+    out << "===== Processing file: " << filename << " =====" << std::endl;
+    PhaseProfile profile;
+
+    // 1. Stream the shares from the file, decoding only the k with the smallest x-values
+    //    (or all of them, to verify them against each other)
+    ShareFile shares;
+    std::string parse_error;
+    bool opened, parsed = false, binary = false;
     try {
-        data = json::parse(json_file);
-    } catch (json::parse_error& e) {
-        std::cerr << "JSON parsing error: " << e.what() << std::endl << std::endl;
+        std::ifstream share_file(filename, std::ios::binary);
+        opened = share_file.is_open();
+        binary = opened && hasBinarySharesMagic(share_file);
+        if (opened && (binary || options.mmap_input)) {
+            share_file.close();
+            MappedFile mapped_file(filename);
+            opened = mapped_file.is_open();
+            if (opened) {
+                parsed = binary ? loadBinaryShares(mapped_file.view(), shares, parse_error, options.verify)
+                                : loadShares(mapped_file.view(), shares, parse_error, options.verify, &profile);
+                if (binary) profile.mark("read binary");
+            }
+        } else if (opened) {
+            parsed = loadShares(share_file, shares, parse_error, options.verify, &profile);
+        }
+    } catch (std::invalid_argument& e) {
+        err << "Error: Invalid share: " << e.what() << std::endl << std::endl;
+        return;
+    } catch (std::out_of_range& e) {
+        err << "Error: Invalid share: " << e.what() << std::endl << std::endl;
         return;
     }
 
-    // 1. Read ALL points from the JSON into a vector
-    size_t k = data["keys"]["k"];
-    std::vector<std::pair<long long, BigInt>> all_points;
-    for (auto const& [key, val] : data.items()) {
-        if (key == "keys") continue;
-        all_points.push_back({std::stoll(key), convertToBase10(val["value"].get<std::string>(), std::stoi(val["base"].get<std::string>()))});
+    if (!opened) {
+        err << "Error: Could not open file " << filename << std::endl << std::endl;
+        return;
     }
+    if (!parsed) {
+        err << (binary ? "Error: Invalid binary share file: " : "JSON parsing error: ") << parse_error << std::endl << std::endl;
+        return;
+    }
+    solveShares(shares, options, out, err, pool, profile);
+}
+
 
-    if (all_points.size() < k) {
-        std::cerr << "Error: Not enough points in file. Have " << all_points.size() << ", need " << k << "." << std::endl << std::endl;
+/**
+ * @brief Processes a share file given as a JSON document rather than a path, such as a server job.
+ *
+ * @param name The name that the progress report gives the document.
+ * @param out Receives the progress report and the answer.
+ * @param err Receives the error messages.
+ * @param pool The thread pool to evaluate the interpolation on, or null to run it on this thread.
+ */
+void processDocument(std::string_view document, const std::string& name, const SolverOptions& options,
+                     std::ostream& out, std::ostream& err, ThreadPool* pool = nullptr) {
+    out << "===== Processing " << name << " =====" << std::endl;
+    PhaseProfile profile;
+
+    ShareFile shares;
+    std::string parse_error;
+    bool parsed;
+    try {
+        parsed = loadShares(document, shares, parse_error, options.verify, &profile);
+    } catch (std::invalid_argument& e) {
+        err << "Error: Invalid share: " << e.what() << std::endl << std::endl;
+        return;
+    } catch (std::out_of_range& e) {
+        err << "Error: Invalid share: " << e.what() << std::endl << std::endl;
+        return;
+    }
+    if (!parsed) {
+        err << "JSON parsing error: " << parse_error << std::endl << std::endl;
         return;
     }
+    solveShares(shares, options, out, err, pool, profile);
+}
+
+
+/**
+ * @brief Processes the files on a work-stealing thread pool of `options.jobs` threads.
+ *
+ * Each file's output is buffered while it is processed and printed as one block once it
+ * and every file before it have finished, so the output matches a sequential run. The
+ * interpolation of each file also runs on the pool, so a single large file uses every thread.
+ */
+void processFilesInParallel(const std::vector<const char*>& filenames, const SolverOptions& options) {
+    struct FileReport {
+        std::ostringstream out, err;
+        std::promise<void> done;
+    };
+    std::vector<FileReport> reports(filenames.size());
+    std::vector<std::future<void>> finished;
+    for (auto& report : reports) finished.push_back(report.done.get_future());
+
+    ThreadPool pool(options.jobs);
+    for (size_t i = 0; i < filenames.size(); i++) {
+        pool.submit([&, i] {
+            FileReport& report = reports[i];
+            try {
+                processFile(filenames[i], options, report.out, report.err, &pool);
+            } catch (std::exception& e) {
+                report.err << "Error: " << e.what() << std::endl << std::endl;
+            }
+            report.done.set_value();
+        });
+    }
+
+    for (size_t i = 0; i < filenames.size(); i++) {
+        finished[i].wait();
+        std::cout << reports[i].out.str() << std::flush;
+        std::cerr << reports[i].err.str() << std::flush;
+    }
+}
+
+/*
+ * Server mode (`--serve`, or `--socket PATH`). Each line of the input is one job: either the
+ * path of a share file, or a whole JSON share file on one line (a line whose first character
+ * other than white space is '{').
+ * The report of each job, with any error messages, is written back in the order the jobs
+ * arrived, and ends with the line
+ *
+ *   ===== End of job N =====
+ *
+ * followed by an empty line, where N counts the jobs of the connection from 1. The thread
+ * pool, the Lagrange weight cache and the radix power tables stay warm across jobs.
+ *
+ * A path job opens any file the server process can read, and its error messages go back to
+ * the client, so every client that can connect to the socket can probe the server's files.
+ * A server that untrusted clients can reach should run with `--inline-only`, which refuses
+ * path jobs.
+ */
+
+// the most jobs of one connection that are queued, running or waiting to be written
+const size_t SERVER_JOBS_IN_FLIGHT = 64;
+
+/**
+ * @brief Runs one server job, returning its report.
+ */
+std::string runJob(const std::string& job, size_t number, const SolverOptions& options, ThreadPool* pool) {
+    std::ostringstream report;
+    try {
+        size_t start = job.find_first_not_of(" \t\f\v");
+        if (start != std::string::npos && job[start] == '{') {
+            processDocument(job, "inline job " + std::to_string(number), options, report, report, pool);
+        } else if (options.inline_jobs_only) {
+            report << "Error: This server only takes inline JSON jobs, not file paths." << std::endl << std::endl;
+        } else {
+            processFile(job.c_str(), options, report, report, pool);
+        }
+    } catch (std::exception& e) {
+        report << "Error: " << e.what() << std::endl << std::endl;
+    }
+    report << "===== End of job " << number << " =====" << std::endl << std::endl;
+    return report.str();
+}
 
-    // 2. Sort all points by their x-coordinate
-    std::sort(all_points.begin(), all_points.end(), [](const auto& a, const auto& b) {
-        return a.first < b.first;
+/**
+ * @brief Reads jobs from `in` until it ends, writing each report to `out` as soon as it and
+ * every job before it have finished.
+ *
+ * With a pool the jobs run concurrently on it while more are being read; without one they
+ * run one at a time on this thread. Once SERVER_JOBS_IN_FLIGHT reports are pending, reading
+ * pauses until the oldest is written, so a fast client cannot queue unbounded work.
+ */
+void serveJobs(std::istream& in, std::ostream& out, const SolverOptions& options, ThreadPool* pool) {
+    std::mutex mutex;
+    std::condition_variable changed;
+    std::deque<std::future<std::string>> reports;
+    bool finished = false;
+
+    std::thread writer([&] {
+        while (true) {
+            std::future<std::string> report;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [&] { return finished || !reports.empty(); });
+                if (reports.empty()) return;
+                report = std::move(reports.front());
+                reports.pop_front();
+            }
+            changed.notify_all(); // there is room for another job
+            out << report.get() << std::flush;
+        }
     });
 
-    // 3. Select the first k points (those with the smallest x-values) for the calculation
-    std::vector<std::pair<long long, BigInt>> points_for_calc(all_points.begin(), all_points.begin() + k);
-    
-    std::cout << "Using the " << k << " points with the smallest x-values for calculation." << std::endl;
+    size_t number = 0;
+    for (std::string job; std::getline(in, job);) {
+        if (!job.empty() && job.back() == '\r') job.pop_back();
+        if (job.empty()) continue;
+        auto report = std::make_shared<std::promise<std::string>>();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            changed.wait(lock, [&] { return reports.size() < SERVER_JOBS_IN_FLIGHT; });
+            reports.push_back(report->get_future());
+        }
+        changed.notify_all();
+        number++;
+        auto task = [&options, pool, report, job = std::move(job), number] {
+            report->set_value(runJob(job, number, options, pool));
+        };
+        if (pool != nullptr) {
+            pool->submit(std::move(task));
+        } else {
+            task();
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        finished = true;
+    }
+    changed.notify_all();
+    writer.join();
+}
 
-    // 4. Calculate the final answer
-    BigInt final_answer = lagrange_interpolate_at_zero(points_for_calc);
+#ifndef _WIN32
+/**
+ * @brief A stream buffer reading from and writing to a connected socket.
+ */
+class SocketStreamBuf : public std::streambuf {
+public:
+    explicit SocketStreamBuf(int socket) : socket(socket) {
+        setg(input, input, input);
+        setp(output, output + sizeof(output));
+    }
+
+    ~SocketStreamBuf() override { sync(); }
+
+protected:
+    int_type underflow() override {
+        ssize_t received;
+        do {
+            received = recv(socket, input, sizeof(input), 0);
+        } while (received < 0 && errno == EINTR);
+        if (received <= 0) return traits_type::eof();
+        setg(input, input, input + received);
+        return traits_type::to_int_type(input[0]);
+    }
+
+    int_type overflow(int_type c) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        for (const char* next = pbase(); next < pptr();) {
+            ssize_t sent = send(socket, next, pptr() - next, MSG_NOSIGNAL); // a closed peer must not raise SIGPIPE
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) return -1;
+            next += sent;
+        }
+        setp(output, output + sizeof(output));
+        return 0;
+    }
+
+private:
+    int socket;
+    char input[1 << 16];
+    char output[1 << 16];
+};
+
+/**
+ * @brief Listens on a Unix socket at `path`, serving the jobs of each connection on its own thread.
+ *
+ * A stale socket left at `path` by an earlier server is replaced; any other file there is an error.
+ * Running out of descriptors or buffers only pauses accepting for a moment. Only returns
+ * on a persistent error, after every connection has finished.
+ *
+ * @return The process exit code.
+ */
+int serveSocket(const std::string& path, const SolverOptions& options, ThreadPool* pool) {
+    sockaddr_un address{};
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << path << std::endl;
+        return 1;
+    }
+    std::copy(path.begin(), path.end(), address.sun_path);
 
-    std::cout << "\n-----------------------------------------" << std::endl;
-    std::cout << "Calculated constant term P(0) = " << final_answer << std::endl;
-    std::cout << "-----------------------------------------" << std::endl << std::endl;
+    struct stat existing;
+    if (lstat(path.c_str(), &existing) == 0 && S_ISSOCK(existing.st_mode)) unlink(path.c_str());
+    int listener = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listener < 0 || bind(listener, (const sockaddr*)&address, sizeof(address)) != 0 || listen(listener, SOMAXCONN) != 0) {
+        std::cerr << "Error: Could not listen on " << path << ": " << std::strerror(errno) << std::endl;
+        if (listener >= 0) close(listener);
+        return 1;
+    }
+
+    struct Connection {
+        int client;
+        std::thread thread;
+        std::shared_ptr<std::atomic<bool>> done;
+    };
+    std::list<Connection> connections;
+    auto joinFinished = [&connections] {
+        for (auto connection = connections.begin(); connection != connections.end();) {
+            if (!*connection->done) {
+                ++connection;
+                continue;
+            }
+            connection->thread.join();
+            close(connection->client);
+            connection = connections.erase(connection);
+        }
+    };
+
+    int status = 0;
+    while (true) {
+        int client = accept(listener, nullptr, nullptr);
+        joinFinished();
+        if (client < 0) {
+            if (errno == EINTR || errno == ECONNABORTED) continue;
+            if (errno == EMFILE || errno == ENFILE || errno == ENOBUFS || errno == ENOMEM) {
+                // transient: wait for connections to close, rather than give up
+                std::this_thread::sleep_for(std::chrono::milliseconds(100));
+                continue;
+            }
+            std::cerr << "Error: Could not accept a connection on " << path << ": " << std::strerror(errno) << std::endl;
+            status = 1;
+            break;
+        }
+        auto done = std::make_shared<std::atomic<bool>>(false);
+        connections.push_back({client, std::thread([client, &options, pool, done] {
+            {
+                SocketStreamBuf buffer(client);
+                std::istream in(&buffer);
+                std::ostream out(&buffer);
+                serveJobs(in, out, options, pool);
+            }
+            shutdown(client, SHUT_RDWR); // the client sees the end now; the descriptor is closed once joined
+            *done = true;
+        }), done});
+    }
+
+    close(listener);
+    for (Connection& connection : connections) {
+        shutdown(connection.client, SHUT_RD); // finish the jobs already read, then stop
+        connection.thread.join();
+        close(connection.client);
+    }
+    return status;
+}
+#endif
+
+
+/**
+ * @brief Prints the peak resident set size of the process and the BigInt operation counts, for --profile.
+ */
+void printRunProfile(std::ostream& out) {
+    std::ostringstream report;
+    report << std::fixed << std::setprecision(1) << "===== Profile of the run =====" << std::endl;
+#ifndef _WIN32
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        report << "Peak resident set size: " << usage.ru_maxrss / 1024.0 << " MiB" << std::endl; // ru_maxrss is in KiB
+    }
+#endif
+#ifdef BIG_INT_OPERATION_COUNTERS
+    OperationCounters::Totals totals = OperationCounters::totals();
+    const char* names[] = {"BigInt * BigInt", "BigInt / BigInt", "BigInt * word", "BigInt / word"};
+    for (size_t i = 0; i < OperationCounters::OPERATIONS; i++) {
+        report << names[i] << ": " << totals.count[i];
+        if (totals.count[i] > 0) {
+            report << " operations, with operands of " << (double)totals.first_limbs[i] / totals.count[i] << " limbs";
+            if (i == OperationCounters::MULTIPLY || i == OperationCounters::DIVIDE) {
+                report << " and " << (double)totals.second_limbs[i] / totals.count[i] << " limbs";
+            }
+            report << " on average";
+        }
+        report << std::endl;
+    }
+#else
+    report << "BigInt operation counts: not collected by this build. To collect them, rebuild with" << std::endl
+           << "  g++ -std=c++17 -O2 -pthread -DBIG_INT_OPERATION_COUNTERS -o solver solver.cpp" << std::endl;
+#endif
+    out << report.str();
 }
 
+#ifndef SOLVER_NO_MAIN // the tests include this file for its functions and bring their own main
 int main(int argc, char* argv[]) {
-    if (argc < 2) {
-        std::cerr << "Usage: " << argv[0] << " <file1.json> <file2.json> ..." << std::endl;
-        return 1;
+    if (argc > 1 && std::string(argv[1]) == "convert") {
+        if (argc != 4) {
+            std::cerr << "Usage: " << argv[0] << " convert <input.json> <output.bin>" << std::endl;
+            return 1;
+        }
+        return convertFile(argv[2], argv[3]);
+    }
+    if (argc > 1 && std::string(argv[1]) == "bench") {
+        return benchmarkCommand(argc, argv);
     }
 
+    SolverOptions options;
+    std::vector<const char*> filenames;
+    bool batch = false;
+    bool serve = false;
+    std::string socket_path;
     for (int i = 1; i < argc; ++i) {
-        processFile(argv[i]);
+        std::string arg = argv[i];
+        if (arg == "--prime" && i + 1 < argc) {
+            try {
+                options.prime = BigInt(argv[++i]);
+            } catch (std::invalid_argument& e) {
+                std::cerr << "Error: " << e.what() << std::endl;
+                return 1;
+            }
+        } else if (arg == "--batch") {
+            batch = true;
+        } else if (arg == "--verify") {
+            options.verify = true;
+        } else if (arg == "--mmap") {
+            options.mmap_input = true;
+        } else if (arg == "--fixed-width") {
+            options.fixed_width = true;
+        } else if (arg == "--profile") {
+            options.profile = true;
+        } else if (arg == "--serve") {
+            serve = true;
+        } else if (arg == "--inline-only") {
+            options.inline_jobs_only = true;
+#ifndef _WIN32
+        } else if (arg == "--socket" && i + 1 < argc) {
+            serve = true;
+            socket_path = argv[++i];
+#endif
+        } else if (arg == "--jobs" && i + 1 < argc) {
+            try {
+                options.jobs = std::stoul(argv[++i]);
+            } catch (std::exception&) {
+                std::cerr << "Error: Invalid job count " << argv[i] << std::endl;
+                return 1;
+            }
+        } else {
+            filenames.push_back(argv[i]);
+        }
+    }
+
+    if (serve) {
+        if (!filenames.empty()) {
+            std::cerr << "Error: The server reads its jobs from its input, not the command line." << std::endl;
+            return 1;
+        }
+        // the point of a long-running server, but bounded, since its clients choose the x-sets
+        options.weight_cache_entries = SERVER_WEIGHT_CACHE_ENTRIES;
+        LagrangeWeightCache weight_cache(options.weight_cache_entries);
+        options.weight_cache = &weight_cache;
+        std::unique_ptr<ThreadPool> pool;
+        if (options.jobs != 1) pool = std::make_unique<ThreadPool>(options.jobs);
+#ifndef _WIN32
+        if (!socket_path.empty()) return serveSocket(socket_path, options, pool.get());
+#endif
+        serveJobs(std::cin, std::cout, options, pool.get());
+        if (options.profile) printRunProfile(std::cout);
+        return 0;
     }
 
+    if (filenames.empty()) {
+        std::cerr << "Usage: " << argv[0] << " [--prime p] [--jobs N] [--mmap] [--verify] [--batch] [--fixed-width] [--profile] <file1.json> <file2.json> ..." << std::endl;
+        std::cerr << "  --prime p  interpolate modulo the prime p (a \"prime\" entry in a file's keys takes precedence)" << std::endl;
+        std::cerr << "  --jobs N   process the files, and each interpolation, on N threads (0 = one per hardware thread)" << std::endl;
+        std::cerr << "  --mmap     memory-map the files and decode the values in place" << std::endl;
+        std::cerr << "  --verify   check every share and exclude corrupted ones (up to (n - k) / 2 per file)" << std::endl;
+        std::cerr << "  --batch    compute the Lagrange weights once per distinct x-set and reuse them across files" << std::endl;
+        std::cerr << "  --fixed-width  interpolate in " << FIXED_WIDTH_BITS << "-bit fixed-width arithmetic (an error if the values do not fit)" << std::endl;
+        std::cerr << "  --profile  report the time of each phase per file, and the peak memory and BigInt operation counts" << std::endl;
+        std::cerr << "             (the counts need a build with -DBIG_INT_OPERATION_COUNTERS)" << std::endl;
+        std::cerr << "Server mode, with the same options, reading one job per line (a file path, or a JSON share file on one line)" << std::endl;
+        std::cerr << "and answering each with its report and \"===== End of job N =====\", reusing the warm caches and threads:" << std::endl;
+        std::cerr << "  " << argv[0] << " [options] --serve          jobs on standard input, reports on standard output" << std::endl;
+        std::cerr << "  " << argv[0] << " [options] --socket PATH    jobs from each connection to a Unix socket at PATH" << std::endl;
+        std::cerr << "  --inline-only  refuse file path jobs, since they let a client read any file the server can" << std::endl;
+        std::cerr << "Files may be JSON or binary share files, made with: " << argv[0] << " convert <input.json> <output.bin>" << std::endl;
+        std::cerr << "Benchmarks, with JSON or CSV results: " << argv[0] << " bench [--format json|csv] [options]" << std::endl;
+        return 1;
+    }
+
+    // a fixed file list has a fixed number of x-sets, so the cache is left unbounded
+    LagrangeWeightCache weight_cache(options.weight_cache_entries);
+    if (batch) options.weight_cache = &weight_cache;
+
+    if (options.jobs == 1) {
+        for (const char* filename : filenames) {
+            processFile(filename, options, std::cout, std::cerr);
+        }
+    } else {
+        processFilesInParallel(filenames, options);
+    }
+    if (options.profile) printRunProfile(std::cout);
+
     return 0;
 }
-
+#endif // SOLVER_NO_MAIN
@@ -0,0 +1,221 @@
+// Checks each BigInt algorithm against a simpler one on operands on both sides of the
+// thresholds where the dispatchers switch between them.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Wall -o bigint_test tests/bigint_test.cpp && ./bigint_test
+
+#include <iostream>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "../BigInt.hpp"
+#include "test_util.hpp"
+
+namespace {
+
+std::mt19937_64 random_limbs(2024);
+
+/**
+ * @brief A random magnitude of exactly `size` limbs. Every fourth one is all ones, to
+ * push carries through every limb.
+ */
+LimbVector randomLimbs(size_t size) {
+    bool all_ones = random_limbs() % 4 == 0;
+    LimbVector num(size);
+    for (size_t i = 0; i < size; i++) num[i] = all_ones ? ~0ULL : random_limbs();
+    if (size > 0 and num[size - 1] == 0) num[size - 1] = 1;
+    return num;
+}
+
+/**
+ * @brief The BigInt with the given limbs, read back through its hexadecimal digits.
+ */
+BigInt toBigInt(const LimbVector& num, bool negative = false) {
+    std::string digits = "0";
+    for (size_t i = num.size(); i-- > 0; ) {
+        for (int shift = 60; shift >= 0; shift -= 4) digits += "0123456789abcdef"[(num[i] >> shift) & 15];
+    }
+    BigInt result = BigInt::from_string(digits, 16);
+    return negative ? -result : result;
+}
+
+std::string sizes(size_t first, size_t second) {
+    return std::to_string(first) + " x " + std::to_string(second) + " limbs";
+}
+
+/**
+ * @brief multiply_limbs and square_limbs against the schoolbook methods, around the
+ * Karatsuba, Toom-3 and NTT thresholds and on the unbalanced path.
+ */
+void testMultiplication() {
+    const size_t balanced[] = {1, 2, KARATSUBA_THRESHOLD - 1, KARATSUBA_THRESHOLD, KARATSUBA_THRESHOLD + 1,
+                               KARATSUBA_SQUARE_THRESHOLD - 1, KARATSUBA_SQUARE_THRESHOLD,
+                               TOOM3_THRESHOLD - 1, TOOM3_THRESHOLD, TOOM3_THRESHOLD + 1,
+                               NTT_THRESHOLD - 1, NTT_THRESHOLD, NTT_THRESHOLD + 1};
+    for (size_t size : balanced) {
+        LimbVector num1 = randomLimbs(size), num2 = randomLimbs(size - size / 7);
+        check(multiply_limbs(num1, num2) == multiply_limbs_schoolbook(num1, num2),
+              "multiply_limbs, " + sizes(num1.size(), num2.size()));
+        check(square_limbs(num1) == square_limbs_schoolbook(num1), "square_limbs, " + sizes(size, size));
+    }
+
+    const size_t unbalanced[][2] = {{2 * KARATSUBA_THRESHOLD, KARATSUBA_THRESHOLD},
+                                    {5 * KARATSUBA_THRESHOLD + 3, KARATSUBA_THRESHOLD + 1},
+                                    {3 * TOOM3_THRESHOLD + 17, TOOM3_THRESHOLD}};
+    for (const auto& size : unbalanced) {
+        LimbVector larger = randomLimbs(size[0]), smaller = randomLimbs(size[1]);
+        LimbVector expected = multiply_limbs_schoolbook(larger, smaller);
+        check(multiply_limbs(larger, smaller) == expected, "multiply_limbs, " + sizes(size[0], size[1]));
+        check(multiply_limbs(smaller, larger) == expected, "multiply_limbs, " + sizes(size[1], size[0]));
+    }
+
+    // signs through the BigInt operators
+    BigInt num1 = toBigInt(randomLimbs(TOOM3_THRESHOLD), true), num2 = toBigInt(randomLimbs(TOOM3_THRESHOLD));
+    check(num1 * num2 == -(abs(num1) * num2) and num1 * num1 == abs(num1) * abs(num1), "BigInt operator* signs");
+}
+
+/**
+ * @brief divide against Algorithm D around the Burnikel-Ziegler threshold, and the
+ * identity dividend = quotient * divisor + remainder with remainder < divisor.
+ */
+void testDivision() {
+    const size_t B = BURNIKEL_ZIEGLER_THRESHOLD;
+    const size_t cases[][2] = {{3, 2}, {B + B - 1, B - 1}, {2 * B - 1, B}, {2 * B, B}, {2 * B + 1, B + 1},
+                               {5 * B, B}, {5 * B + 7, 2 * B + 3}, {40 * B, 9 * B}, {B, B}};
+    for (const auto& size : cases) {
+        LimbVector dividend = randomLimbs(size[0]), divisor = randomLimbs(size[1]);
+        LimbVector quotient, remainder;
+        std::tie(quotient, remainder) = divide(dividend, divisor);
+        std::string label = "divide, " + sizes(size[0], size[1]);
+        check(std::make_tuple(quotient, remainder) == divide_knuth(dividend, divisor), label + " against divide_knuth");
+        check(compare_limbs(remainder, divisor) < 0, label + ": remainder < divisor");
+        LimbVector product = multiply_limbs(quotient, divisor);
+        check(add_limbs(product, remainder) == dividend, label + ": quotient * divisor + remainder");
+    }
+
+    // truncated division of every sign combination
+    for (int signs = 0; signs < 4; signs++) {
+        BigInt dividend = toBigInt(randomLimbs(3 * B), signs & 1), divisor = toBigInt(randomLimbs(B + 5), signs & 2);
+        BigInt quotient = dividend / divisor, remainder = dividend % divisor;
+        check(quotient * divisor + remainder == dividend and abs(remainder) < abs(divisor)
+                  and (remainder == 0 or (remainder < 0) == (dividend < 0)),
+              "BigInt operator/ and operator% signs " + std::to_string(signs));
+    }
+}
+
+/**
+ * @brief gcd, ext_gcd and mod_inverse against Euclid's algorithm by division, for
+ * operands from one limb (binary GCD only) to many (Lehmer's algorithm).
+ */
+void testGcd() {
+    std::vector<std::vector<size_t>> cases = {{1, 1, 0}, {2, 1, 1}, {3, 2, 1}, {3, 3, 2}, {12, 9, 3},
+                                              {120, 100, 7}, {700, 690, 40}, {300, 2, 0}};
+    for (int i = 0; i < 200; i++) { // Lehmer steps whose cofactors have every sign pattern
+        size_t size = 1 + random_limbs() % 8;
+        cases.push_back({size, 1 + random_limbs() % size, random_limbs() % 3});
+    }
+    for (const auto& size : cases) {
+        // a common factor makes the gcd non-trivial
+        BigInt common = size[2] > 0 ? toBigInt(randomLimbs(size[2])) : BigInt(1);
+        BigInt num1 = toBigInt(randomLimbs(size[0])) * common, num2 = toBigInt(randomLimbs(size[1])) * common;
+        BigInt a = num1, b = num2;
+        while (b != 0) {
+            a %= b;
+            std::swap(a, b);
+        }
+        std::string label = sizes(size[0] + size[2], size[1] + size[2]);
+        check(gcd(num1, num2) == a, "gcd, " + label);
+        check(gcd(num2, -num1) == a, "gcd with a negative operand, " + label);
+
+        BigInt g, x, y;
+        std::tie(g, x, y) = ext_gcd(num1, -num2);
+        check(g == a and num1 * x - num2 * y == g, "ext_gcd, " + label);
+
+        if (a == 1 and num2 > 1) {
+            BigInt inverse = mod_inverse(num1, num2);
+            check(inverse >= 0 and inverse < num2 and num1 * inverse % num2 == 1, "mod_inverse, " + label);
+        }
+    }
+}
+
+/**
+ * @brief Parsing and formatting against Horner's method and repeated division, around
+ * the divide and conquer threshold, in bases with and without a power of two.
+ */
+void testRadixConversion() {
+    for (int base : {10, 16, 7, 36, 2}) {
+        size_t chunk = radix_chunk_length(base);
+        for (size_t chunks : {size_t(1), RADIX_DIVIDE_AND_CONQUER_THRESHOLD,
+                              RADIX_DIVIDE_AND_CONQUER_THRESHOLD + 1, 20 * RADIX_DIVIDE_AND_CONQUER_THRESHOLD + 3}) {
+            std::string digits(chunks * chunk - chunk / 2, '0');
+            for (char& digit : digits) digit = RADIX_DIGITS[random_limbs() % base];
+            digits[0] = RADIX_DIGITS[1 + random_limbs() % (base - 1)];
+            std::string label = "base " + std::to_string(base) + ", " + std::to_string(digits.size()) + " digits";
+
+            LimbVector num = parse_limbs(digits, base);
+            check(num == parse_limbs_horner(digits, base, chunk), "parse_limbs, " + label);
+
+            std::string expected, formatted;
+            format_limbs_schoolbook(expected, num, base, 0);
+            check(expected == digits, "format_limbs_schoolbook, " + label);
+            format_limbs(formatted, num, base, 0);
+            check(formatted == digits, "format_limbs, " + label);
+            check(toBigInt(num).to_string(base) == digits, "to_string, " + label);
+            check(toBigInt(num, true).to_string(base) == "-" + digits, "to_string of a negative, " + label);
+        }
+    }
+}
+
+/**
+ * @brief Both forms of Montgomery::multiply against multiplying and reducing, including
+ * products stored over an operand with one scratch residue, and the modulus check.
+ */
+void testMontgomery() {
+    for (size_t size : {size_t(1), size_t(4), size_t(33)}) {
+        LimbVector modulus_limbs = randomLimbs(size);
+        modulus_limbs[0] |= 1;
+        BigInt modulus = toBigInt(modulus_limbs);
+        if (modulus < 3) modulus = 3;
+        Montgomery field(modulus);
+        std::string label = "Montgomery, " + std::to_string(size) + " limbs";
+
+        BigInt expected = 1;
+        Montgomery::Residue product = field.one(), scratch;
+        for (int i = 0; i < 20; i++) {
+            BigInt num1 = toBigInt(randomLimbs(size)) % modulus, num2 = toBigInt(randomLimbs(size)) % modulus;
+            check(field.from_montgomery(field.multiply(field.to_montgomery(num1), field.to_montgomery(num2)))
+                      == num1 * num2 % modulus, label + ": multiply");
+            field.multiply(product, product, field.to_montgomery(num1), scratch);
+            expected = expected * num1 % modulus;
+        }
+        check(field.from_montgomery(product) == expected, label + ": multiply into an operand");
+    }
+
+    for (long long modulus : {-3LL, 0LL, 1LL, 2LL, 10LL}) {
+        bool threw = false;
+        try {
+            Montgomery field(modulus);
+        } catch (std::invalid_argument&) {
+            threw = true;
+        }
+        check(threw, "Montgomery rejects the modulus " + std::to_string(modulus));
+    }
+}
+
+} // namespace
+
+int main() {
+    testMultiplication();
+    testDivision();
+    testGcd();
+    testRadixConversion();
+    testMontgomery();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All BigInt checks passed." << std::endl;
+    return 0;
+}
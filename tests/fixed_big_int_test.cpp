@@ -0,0 +1,264 @@
+// Checks FixedBigInt against BigInt at 256 and 512 bits, at the edges of its range, with its
+// division evaluated at compile time, and in the --fixed-width interpolation.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Wall -pthread -o fixed_big_int_test tests/fixed_big_int_test.cpp && ./fixed_big_int_test
+
+#define SOLVER_NO_MAIN
+#include "../solver.cpp"
+
+#include "test_util.hpp"
+
+namespace {
+
+std::mt19937_64 random_bits(2024);
+
+/**
+ * @brief A random value of up to `bits` bits, of either sign. Every fourth one has all its
+ * bits set, to push carries through every limb.
+ */
+BigInt randomValue(size_t bits) {
+    bool all_ones = random_bits() % 4 == 0;
+    std::vector<uint64_t> limbs((bits + 63) / 64);
+    for (uint64_t& limb : limbs) limb = all_ones ? ~0ULL : random_bits();
+    if (bits % 64 != 0) limbs.back() &= (1ULL << (bits % 64)) - 1;
+    return BigInt::from_limbs(limbs.data(), limbs.size(), random_bits() % 2);
+}
+
+/**
+ * @brief Whether computing the value threw std::overflow_error.
+ */
+template <class Function>
+bool overflows(Function compute) {
+    try {
+        compute();
+    } catch (std::overflow_error&) {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief Checks a FixedBigInt result against the BigInt one: equal when it is in range,
+ * an overflow_error when it is not.
+ */
+template <size_t Bits, class Function>
+void checkAgainst(const BigInt& expected, Function compute, const std::string& label) {
+    typedef FixedBigInt<Bits> Fixed;
+    BigInt limit = pow(BigInt(2), Bits - 1);
+    if (abs(expected) < limit) {
+        Fixed result;
+        bool threw = overflows([&] { result = compute(); });
+        check(!threw and result.to_big_int() == expected, label);
+    } else {
+        check(overflows(compute), label + " overflows");
+    }
+}
+
+/**
+ * @brief The operators, gcd and mod_inverse against BigInt on operands of every length,
+ * so that sums and products land on both sides of the range.
+ */
+template <size_t Bits>
+void testArithmetic() {
+    typedef FixedBigInt<Bits> Fixed;
+    std::string width = std::to_string(Bits) + " bits";
+    for (int round = 0; round < 2000; round++) {
+        BigInt num1 = randomValue(1 + random_bits() % (Bits - 1)), num2 = randomValue(1 + random_bits() % (Bits - 1));
+        Fixed fixed1 = Fixed::from_big_int(num1), fixed2 = Fixed::from_big_int(num2);
+        std::string label = width + ", " + num1.to_string() + " and " + num2.to_string();
+        check(fixed1.to_big_int() == num1 and Fixed::from_string(num1.to_string(), 10) == fixed1, "round trip, " + label);
+        check((fixed1 < fixed2) == (num1 < num2) and (fixed1 == fixed2) == (num1 == num2), "compare, " + label);
+
+        checkAgainst<Bits>(num1 + num2, [&] { return fixed1 + fixed2; }, "+, " + label);
+        checkAgainst<Bits>(num1 - num2, [&] { return fixed1 - fixed2; }, "-, " + label);
+        checkAgainst<Bits>(num1 * num2, [&] { return fixed1 * fixed2; }, "*, " + label);
+        if (num2 != 0) {
+            check(fixed1 / fixed2 == Fixed::from_big_int(num1 / num2), "/, " + label);
+            check(fixed1 % fixed2 == Fixed::from_big_int(num1 % num2), "%, " + label);
+        }
+        check(gcd(fixed1, fixed2) == Fixed::from_big_int(gcd(num1, num2)), "gcd, " + label);
+
+        BigInt modulus = abs(num2);
+        if (modulus < 2) continue;
+        bool invertible = gcd(num1, modulus) == 1, threw = false;
+        try {
+            Fixed inverse = mod_inverse(fixed1, Fixed::from_big_int(modulus));
+            check(invertible and inverse.to_big_int() == mod_inverse(num1, modulus), "mod_inverse, " + label);
+        } catch (std::invalid_argument&) {
+            threw = true;
+        }
+        check(threw != invertible, "mod_inverse throws only without an inverse, " + label);
+    }
+}
+
+/**
+ * @brief Every operation at the ends of the range (-2^(Bits-1), 2^(Bits-1)), including the
+ * two's complement minimum -2^(Bits-1), which no operation may return.
+ */
+template <size_t Bits>
+void testOverflowEdges() {
+    typedef FixedBigInt<Bits> Fixed;
+    std::string width = std::to_string(Bits) + " bits";
+    BigInt limit = pow(BigInt(2), Bits - 1);
+    Fixed max = Fixed::from_big_int(limit - 1), min = -max, one = 1;
+
+    check(max.to_big_int() == limit - 1 and min.to_big_int() == 1 - limit, width + ": the largest magnitude");
+    check(overflows([&] { return Fixed::from_big_int(limit); }), width + ": from_big_int of 2^(Bits-1)");
+    check(overflows([&] { return Fixed::from_big_int(-limit); }), width + ": from_big_int of -2^(Bits-1)");
+    check(overflows([&] { return Fixed::from_string(limit.to_string(16), 16); }), width + ": from_string of 2^(Bits-1)");
+
+    check(overflows([&] { return max + one; }), width + ": max + 1");
+    check(overflows([&] { return min - one; }), width + ": -max - 1");
+    check(overflows([&] { return min + Fixed(-1); }), width + ": -max + -1");
+    check(overflows([&] { return Fixed(-1) - max; }), width + ": -1 - max");
+    check(overflows([&] { return max - Fixed(-1); }), width + ": max - -1");
+    check(overflows([&] { return min + min; }), width + ": -max + -max");
+    check(max + min == 0 and max - max == 0 and (min + one).to_big_int() == 2 - limit, width + ": sums inside the range");
+
+    check(max * one == max and min * one == min and min * Fixed(-1) == max and -min == max, width + ": max times one");
+    check(max / Fixed(-1) == min and min / Fixed(-1) == max and min % Fixed(-1) == 0, width + ": max divided by -1");
+    check(gcd(min, max) == max and gcd(min, Fixed(0)) == max, width + ": gcd of the largest magnitudes");
+    check(min % Fixed(7) == Fixed::from_big_int((1 - limit) % 7), width + ": -max % 7");
+
+    Fixed half = Fixed::from_big_int(pow(BigInt(2), Bits / 2)), quarter = half / Fixed(2);
+    check(overflows([&] { return half * half; }), width + ": 2^(Bits/2) squared");
+    check(overflows([&] { return half * quarter; }), width + ": a product of exactly 2^(Bits-1)");
+    check(overflows([&] { return (-half) * quarter; }), width + ": a product of exactly -2^(Bits-1)");
+    check(overflows([&] { return max * Fixed(2); }) and overflows([&] { return min * Fixed(-2); }), width + ": max times 2");
+    check((half * (quarter - one)).to_big_int() == limit - pow(BigInt(2), Bits / 2), width + ": a product just inside the range");
+    check((Fixed(3) * Fixed::from_big_int(limit / 3)).to_big_int() == limit / 3 * 3, width + ": 3 * (2^(Bits-1) / 3)");
+
+    bool threw = false;
+    try {
+        max / Fixed(0);
+    } catch (std::logic_error&) {
+        threw = true;
+    }
+    check(threw, width + ": division by zero");
+}
+
+/**
+ * @brief A FixedBigInt built at compile time from a seed, with magnitude below 2^bits and
+ * runs of set bits, so that quotient estimates need correcting.
+ */
+template <size_t Bits>
+constexpr FixedBigInt<Bits> patterned(uint64_t seed, size_t bits) {
+    FixedBigInt<Bits> result = 0;
+    for (size_t chunk = 0; chunk < bits / 32; chunk++) {
+        seed ^= seed << 13;
+        seed ^= seed >> 7;
+        seed ^= seed << 17;
+        long long piece = seed % 3 == 0 ? 0xffffffffLL : (long long)(seed & 0xffffffff);
+        result = result * FixedBigInt<Bits>(1LL << 32) + FixedBigInt<Bits>(piece);
+    }
+    return seed % 2 ? FixedBigInt<Bits>(0) - result : result;
+}
+
+template <size_t Bits>
+struct DivisionCase {
+    FixedBigInt<Bits> dividend, divisor, quotient, remainder;
+};
+
+/**
+ * @brief Divides multi-limb operands in a constant expression, where divide takes the
+ * portable 128-bit path instead of divq.
+ */
+template <size_t Bits, size_t Count>
+constexpr std::array<DivisionCase<Bits>, Count> constantDivisions() {
+    std::array<DivisionCase<Bits>, Count> cases{};
+    for (size_t i = 0; i < Count; i++) {
+        size_t divisor_bits = 96 + 32 * (i % (Bits / 32 - 4));
+        size_t dividend_bits = divisor_bits + 32 * (i % 5);
+        if (dividend_bits > Bits - 32) dividend_bits = Bits - 32;
+        DivisionCase<Bits>& division = cases[i];
+        division.dividend = patterned<Bits>(0x9e3779b97f4a7c15ULL * (i + 1), dividend_bits);
+        division.divisor = patterned<Bits>(0xbf58476d1ce4e5b9ULL * (i + 1), divisor_bits);
+        if (division.divisor == 0) division.divisor = 3;
+        division.quotient = division.dividend / division.divisor;
+        division.remainder = division.dividend % division.divisor;
+    }
+    return cases;
+}
+
+/**
+ * @brief The run time division, with divq on x86-64, against the constant-evaluated one and BigInt.
+ */
+template <size_t Bits>
+void testConstantDivision() {
+    static constexpr std::array<DivisionCase<Bits>, 40> cases = constantDivisions<Bits, 40>();
+    for (const DivisionCase<Bits>& division : cases) {
+        std::string label = std::to_string(Bits) + " bits, " + division.dividend.to_string() + " / " + division.divisor.to_string();
+        check(division.dividend / division.divisor == division.quotient, "quotient against the constant path, " + label);
+        check(division.dividend % division.divisor == division.remainder, "remainder against the constant path, " + label);
+        BigInt dividend = division.dividend.to_big_int(), divisor = division.divisor.to_big_int();
+        check(division.quotient.to_big_int() == dividend / divisor and division.remainder.to_big_int() == dividend % divisor,
+              "constant path against BigInt, " + label);
+    }
+}
+
+/**
+ * @brief interpolateInFixedWidth against the BigInt interpolation, over the integers and a
+ * prime field, and its errors when a value does not fit or P(0) is not an integer.
+ */
+void testFixedWidthInterpolation(std::mt19937_64& random) {
+    for (size_t k = 1; k <= 6; k++) {
+        std::string label = "k = " + std::to_string(k);
+        std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, randomKeys(random, k));
+        check(interpolateInFixedWidth<FIXED_WIDTH_BITS>(shares, 0) == lagrange_interpolate_at_zero(shares),
+              label + ": over the integers");
+
+        BigInt prime(MERSENNE_127);
+        BigInt expected = lagrange_interpolate_at_zero(shares, prime);
+        check(interpolateInFixedWidth<256>(shares, prime) == expected and interpolateInFixedWidth<512>(shares, prime) == expected,
+              label + ": over the prime field of order 2^127 - 1");
+    }
+
+    std::vector<std::pair<long long, BigInt>> wide = {{1, pow(BigInt(2), FIXED_WIDTH_BITS)}, {2, 1}};
+    check(overflows([&] { return interpolateInFixedWidth<FIXED_WIDTH_BITS>(wide, 0); }), "a share too wide to fit");
+    check(!overflows([&] { return interpolateInFixedWidth<256>(randomShares(random, 2, {1, 2}), pow(BigInt(2), 127) + 1); }),
+          "a 128-bit prime fits in 256 bits");
+    check(overflows([&] { return interpolateInFixedWidth<256>(randomShares(random, 2, {1, 2}), pow(BigInt(2), 200) + 1); }),
+          "a prime whose square does not fit");
+
+    bool threw = false;
+    try {
+        interpolateInFixedWidth<FIXED_WIDTH_BITS>({{1, 0}, {3, 1}}, 0); // P(0) = -1/2
+    } catch (std::overflow_error&) {
+    } catch (std::runtime_error&) {
+        threw = true;
+    }
+    check(threw, "a P(0) that is not an integer");
+
+    // the option end to end, on the sample files
+    SolverOptions options;
+    options.fixed_width = true;
+    const char* files[][2] = {{"testcase1.json", "P(0) = 3\n"}, {"testcase2.json", "P(0) = -6290016743746469796\n"}};
+    for (const auto& file : files) {
+        std::ostringstream out, err;
+        processFile(file[0], options, out, err);
+        check(err.str().empty() and out.str().find(file[1]) != std::string::npos, std::string("--fixed-width on ") + file[0]);
+    }
+}
+
+} // namespace
+
+int main() {
+    testArithmetic<256>();
+    testArithmetic<512>();
+    testOverflowEdges<256>();
+    testOverflowEdges<512>();
+    check(overflows([] { return FixedBigInt<64>(LLONG_MIN); }) and FixedBigInt<64>(LLONG_MIN + 1).to_big_int() == LLONG_MIN + 1,
+          "64 bits: LLONG_MIN is out of range");
+    testConstantDivision<256>();
+    testConstantDivision<512>();
+    std::mt19937_64 random(2024);
+    testFixedWidthInterpolation(random);
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All FixedBigInt checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,107 @@
+// Checks Interpolator against lagrange_interpolate_at_zero on random shares.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Wall -pthread -o interpolator_test tests/interpolator_test.cpp && ./interpolator_test
+
+#define SOLVER_NO_MAIN
+#include "../solver.cpp"
+
+#include "test_util.hpp"
+
+namespace {
+
+/**
+ * @brief P(0) from the Interpolator should match lagrange_interpolate_at_zero, before and
+ * after an interior node is removed.
+ */
+void testAgainstLagrange(std::mt19937_64& random, size_t k) {
+    std::string label = "k = " + std::to_string(k);
+    std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, randomKeys(random, k + 1));
+
+    Interpolator interpolator;
+    std::vector<std::pair<long long, BigInt>> first(shares.begin(), shares.begin() + k);
+    for (const auto& share : first) interpolator.add_point(share.first, share.second);
+    check(interpolator.size() == k, label + ": size after add_point");
+    check(interpolator.evaluate(0) == lagrange_interpolate_at_zero(first), label + ": evaluate(0) after add_point");
+
+    // the extra share lies on the same polynomial
+    check(interpolator.evaluate(shares[k].first) == shares[k].second, label + ": evaluate at an extra share");
+
+    // swap an interior node for the extra share
+    size_t removed = k / 2;
+    interpolator.remove_point(shares[removed].first);
+    interpolator.add_point(shares[k].first, shares[k].second);
+    std::vector<std::pair<long long, BigInt>> replaced = first;
+    replaced[removed] = shares[k];
+    check(interpolator.evaluate(0) == lagrange_interpolate_at_zero(replaced), label + ": evaluate(0) after remove_point");
+    for (const auto& share : replaced) {
+        check(interpolator.evaluate(share.first) == share.second, label + ": evaluate at a node after remove_point");
+    }
+
+    // with arbitrary y values the polynomial through the remaining nodes changes degree
+    if (k < 2) return;
+    Interpolator arbitrary;
+    std::vector<std::pair<long long, BigInt>> points = first;
+    for (auto& point : points) {
+        point.second = randomBigInt(random, 30);
+        arbitrary.add_point(point.first, point.second);
+    }
+    arbitrary.remove_point(points[removed].first);
+    points.erase(points.begin() + removed);
+    bool integral = true;
+    BigInt expected;
+    try {
+        expected = lagrange_interpolate_at_zero(points);
+    } catch (std::runtime_error&) {
+        integral = false;
+    }
+    try {
+        BigInt value = arbitrary.evaluate(0);
+        check(integral and value == expected, label + ": evaluate(0) of arbitrary points after remove_point");
+    } catch (std::runtime_error&) {
+        check(!integral, label + ": evaluate(0) threw for an integer P(0)");
+    }
+}
+
+/**
+ * @brief add_point and remove_point should reject duplicate and unknown nodes.
+ */
+void testInvalidNodes() {
+    Interpolator interpolator;
+    interpolator.add_point(3, 7);
+    bool threw = false;
+    try {
+        interpolator.add_point(3, 8);
+    } catch (std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "add_point of a duplicate node");
+
+    threw = false;
+    try {
+        interpolator.remove_point(4);
+    } catch (std::invalid_argument&) {
+        threw = true;
+    }
+    check(threw, "remove_point of an unknown node");
+
+    interpolator.remove_point(3);
+    check(interpolator.size() == 0 and interpolator.evaluate(0) == 0, "remove_point of the last node");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 random(2024);
+    for (size_t k = 1; k <= 40; k++) {
+        for (int round = 0; round < 5; round++) testAgainstLagrange(random, k);
+    }
+    testInvalidNodes();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All Interpolator checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,406 @@
+// Checks how share files are loaded: the selection of the k shares with the smallest
+// x-coordinates by ShareFileReader, from a stream and from memory, ShareScanner against
+// the JSON parser, and the binary share format.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Wall -pthread -o share_file_test tests/share_file_test.cpp && ./share_file_test
+
+#define SOLVER_NO_MAIN
+#include "../solver.cpp"
+
+#include <filesystem>
+#include "test_util.hpp"
+
+namespace {
+
+/**
+ * @brief One share as written in a file: its key, base and digits, and the value they encode.
+ */
+struct WrittenShare {
+    std::string key;
+    int base;
+    std::string digits;
+    BigInt value;
+};
+
+/**
+ * @brief A share with x-coordinate x and a random value in a random base.
+ *
+ * @param zeros How many leading zeros to write the key with, so that duplicate
+ *              x-coordinates can still be distinct JSON keys.
+ */
+WrittenShare randomShare(std::mt19937_64& random, long long x, size_t zeros = 0) {
+    const int bases[] = {2, 10, 16, 36};
+    int base = bases[random() % 4];
+    std::string digits(1 + random() % 60, '0');
+    for (char& digit : digits) digit = RADIX_DIGITS[random() % base];
+    if (random() % 16 == 0) digits = "0";
+    std::string key = std::to_string(x < 0 ? -x : x);
+    key.insert(0, zeros, '0');
+    if (x < 0) key.insert(key.begin(), '-');
+    return {key, base, digits, BigInt::from_string(digits, base)};
+}
+
+/**
+ * @brief The JSON text of a share file, with the keys block first, last or after `keys_after`
+ * shares, or left out when keys_after is negative.
+ */
+std::string shareFileText(const std::vector<WrittenShare>& shares, size_t k, long long keys_after) {
+    std::string keys = "\"keys\": {\"n\": " + std::to_string(shares.size()) + ", \"k\": " + std::to_string(k) + "}";
+    std::string text = "{";
+    for (size_t i = 0; i <= shares.size(); i++) {
+        if ((long long)i == keys_after) text += (text.size() > 1 ? ", " : "") + keys;
+        if (i == shares.size()) break;
+        const WrittenShare& share = shares[i];
+        text += (text.size() > 1 ? ", \"" : "\"") + share.key + "\": {\"base\": \"" + std::to_string(share.base)
+                + "\", \"value\": \"" + share.digits + "\"}";
+    }
+    return text + "}";
+}
+
+/**
+ * @brief Loads a share file from its text, through the stream or the in-memory loader.
+ */
+bool load(const std::string& text, bool in_memory, bool all_shares, ShareFile& shares) {
+    std::string error;
+    if (in_memory) return loadShares(std::string_view(text), shares, error, all_shares);
+    std::istringstream input(text);
+    return loadShares(input, shares, error, all_shares);
+}
+
+/**
+ * @brief Checks what the reader selected against sorting every share by x and keeping the
+ * first k. Where x-coordinates repeat, any of the shares with that x may be kept.
+ */
+void checkSelection(const std::vector<WrittenShare>& written, size_t k, bool all_shares, const ShareFile& shares,
+                    const std::string& label) {
+    std::vector<std::pair<long long, BigInt>> expected;
+    std::multimap<long long, BigInt> by_x;
+    for (const WrittenShare& share : written) {
+        expected.push_back({std::stoll(share.key), share.value});
+        by_x.insert(expected.back());
+    }
+    std::stable_sort(expected.begin(), expected.end(), [](const auto& a, const auto& b) { return a.first < b.first; });
+    if (!all_shares && expected.size() > k) expected.resize(k);
+
+    check(shares.has_k and shares.k == k and shares.count == written.size(), label + ": k and the share count");
+    check(shares.points.size() == expected.size(), label + ": the number of shares kept");
+    if (shares.points.size() != expected.size()) return;
+    for (size_t i = 0; i < expected.size(); i++) {
+        auto [first, last] = by_x.equal_range(shares.points[i].first);
+        bool written_share = std::any_of(first, last, [&](const auto& share) { return share.second == shares.points[i].second; });
+        check(shares.points[i].first == expected[i].first and written_share, label + ": share " + std::to_string(i));
+    }
+}
+
+/**
+ * @brief Shuffled files of up to thousands of shares, so that the buffer is trimmed many
+ * times, with k below, at and above the share count, and the keys block anywhere.
+ */
+void testSelection(std::mt19937_64& random) {
+    for (size_t n : {size_t(1), size_t(7), size_t(100), size_t(5000)}) {
+        for (size_t k : {size_t(1), size_t(3), n / 2 + 1, n, n + 4}) {
+            std::vector<WrittenShare> written;
+            for (long long x : randomKeys(random, std::min<size_t>(n, 2001))) written.push_back(randomShare(random, x));
+            while (written.size() < n) written.push_back(randomShare(random, 1000 + (long long)(random() % 1000000)));
+            std::shuffle(written.begin(), written.end(), random);
+
+            long long keys_after = random() % 3 == 0 ? 0 : random() % 2 ? (long long)n : (long long)(random() % (n + 1));
+            std::string text = shareFileText(written, k, keys_after);
+            for (bool in_memory : {false, true}) {
+                for (bool all_shares : {false, true}) {
+                    std::string label = "n = " + std::to_string(n) + ", k = " + std::to_string(k)
+                                        + (in_memory ? ", in memory" : ", streamed") + (all_shares ? ", all shares" : "");
+                    ShareFile shares;
+                    check(load(text, in_memory, all_shares, shares), label + ": loads");
+                    checkSelection(written, k, all_shares, shares, label);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * @brief x-coordinates that repeat, written as different keys such as "7" and "007", both
+ * inside and across the boundary of the k smallest.
+ */
+void testDuplicateKeys(std::mt19937_64& random) {
+    for (size_t n : {size_t(20), size_t(3000)}) {
+        std::vector<WrittenShare> written;
+        std::map<long long, size_t> repeats;
+        for (size_t i = 0; i < n; i++) {
+            long long x = random() % (n / 4);
+            written.push_back(randomShare(random, x, repeats[x]++));
+        }
+        std::shuffle(written.begin(), written.end(), random);
+        for (size_t k : {size_t(2), n / 8, n / 3}) {
+            std::string text = shareFileText(written, k, random() % (n + 1));
+            for (bool in_memory : {false, true}) {
+                ShareFile shares;
+                std::string label = "duplicates, n = " + std::to_string(n) + ", k = " + std::to_string(k)
+                                    + (in_memory ? ", in memory" : ", streamed");
+                check(load(text, in_memory, false, shares), label + ": loads");
+                checkSelection(written, k, false, shares, label);
+            }
+        }
+    }
+}
+
+/**
+ * @brief A file without a keys block, or without k, loads with has_k unset and no shares
+ * decoded; a bad digit is reported only when its share is selected.
+ */
+void testMissingKeysAndBadDigits(std::mt19937_64& random) {
+    std::vector<WrittenShare> written;
+    for (long long x = 1; x <= 50; x++) written.push_back(randomShare(random, x));
+    std::shuffle(written.begin(), written.end(), random);
+
+    for (bool in_memory : {false, true}) {
+        std::string label = in_memory ? "in memory" : "streamed";
+        ShareFile shares;
+        check(load(shareFileText(written, 3, -1), in_memory, false, shares) and !shares.has_k and shares.points.empty()
+                  and shares.count == written.size(),
+              label + ": no keys block");
+
+        std::string text = shareFileText(written, 3, 0);
+        text.replace(text.find("\"k\": 3"), 6, "\"m\": 3");
+        ShareFile without_k;
+        check(load(text, in_memory, false, without_k) and !without_k.has_k and without_k.points.empty(), label + ": no k");
+
+        std::vector<WrittenShare> bad = written;
+        for (WrittenShare& share : bad) {
+            if (std::stoll(share.key) == 40) share.digits += "!";
+        }
+        ShareFile unselected;
+        check(load(shareFileText(bad, 3, 0), in_memory, false, unselected) and unselected.points.size() == 3,
+              label + ": a bad digit in a share that is not selected");
+
+        bool threw = false;
+        try {
+            ShareFile selected;
+            load(shareFileText(bad, 45, 0), in_memory, false, selected);
+        } catch (std::invalid_argument&) {
+            threw = true;
+        }
+        check(threw, label + ": a bad digit in a selected share");
+    }
+}
+
+/**
+ * @brief What loading a document gave: its result, error and contents, or the exception.
+ */
+std::string loadOutcome(const std::string& text, bool in_memory) {
+    ShareFile shares;
+    std::string error, outcome;
+    try {
+        bool loaded;
+        if (in_memory) {
+            loaded = loadShares(std::string_view(text), shares, error);
+        } else {
+            std::istringstream input(text);
+            loaded = loadShares(input, shares, error);
+        }
+        outcome = loaded ? "loaded" : "failed: " + error;
+    } catch (std::invalid_argument&) {
+        return "invalid_argument";
+    } catch (std::out_of_range&) {
+        return "out_of_range";
+    }
+    outcome += ", k " + (shares.has_k ? std::to_string(shares.k) : "missing") + ", prime " + shares.prime
+               + ", count " + std::to_string(shares.count);
+    for (const auto& [x, y] : shares.points) outcome += ", (" + std::to_string(x) + ", " + y.to_string() + ")";
+    return outcome;
+}
+
+/**
+ * @brief The in-memory loader, which reads with ShareScanner and falls back to the JSON
+ * parser, against the stream loader, which always uses the parser, on documents that take
+ * each path: valid ones, ones using JSON the scanner leaves to the parser, and invalid ones.
+ */
+void testScannerAgainstParser() {
+    std::string shares = "\"1\": {\"base\": \"10\", \"value\": \"4\"}, \"2\": {\"base\": \"2\", \"value\": \"111\"}";
+    std::string deep = std::string(100, '[') + std::string(100, ']');
+    const std::vector<std::string> documents = {
+        "{\"keys\": {\"n\": 2, \"k\": 2}, " + shares + "}",
+        " \r\n\t{ \"keys\" : { \"k\" : 2 , \"prime\" : \"97\" } ,\n " + shares + " }\n",
+        "{}",
+        "{ }",
+        "{\"keys\": {\"k\": \"2\"}, \"1\": {\"base\": 16, \"value\": 255}, \"-3\": {\"base\": 10.0, \"value\": \"-12\"}}",
+        "{\"keys\": {\"k\": 2e0, \"note\": [1, {\"a\": null}]}, \"x\": [true, false, null, -0.5e-3, \"s\"], " + shares + "}",
+        "{\"keys\": {\"k\": 1}, \"1\": {\"base\": \"10\", \"value\": \"\\u0031\\u0032\", \"nested\": {\"value\": \"9\"}}}",
+        "{\"keys\": {\"k\": 1, \"note\": \"caf\xc3\xa9\"}, " + shares + "}",
+        "{\"keys\": {\"k\": 1}, \"deep\": " + deep + ", " + shares + "}",
+        "{\"keys\": {\"k\": 1}, \"1\": {\"base\": \"10\", \"value\": \"7\", \"value\": \"8\"}}",
+        "{\"keys\": {\"k\": 1}, \"1\": {\"value\": \"7\", \"base\": \"10\"}, \"1\": {\"base\": \"10\", \"value\": \"5\"}}",
+        "[{\"base\": \"10\", \"value\": \"4\"}]",
+        "",
+        "\xef\xbb\xbf{\"keys\": {\"k\": 2}, " + shares + "}",
+        "{\"keys\": {\"k\": 2}, " + shares + "} x",
+        "{\"keys\": {\"k\": 2}, " + shares + ",}",
+        "{\"keys\": {\"k\": 2}, " + shares,
+        "{\"keys\": {\"k\": 01}, " + shares + "}",
+        "{\"keys\": {\"k\" 2}, " + shares + "}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": \"4",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": \"4\n\"}}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": \"4\"} \"2\": {}}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\"}}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": \"\"}}",
+        "{\"keys\": {\"k\": 2}, \"one\": {\"base\": \"10\", \"value\": \"4\"}}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"ten\", \"value\": \"4\"}}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": \"4\"}, \"x\": tru}",
+        "{\"keys\": {\"k\": 2}, \"1\": {\"base\": \"10\", \"value\": 1.}}",
+    };
+    for (size_t i = 0; i < 6; i++) { // the forms share files use are read without the parser
+        ShareFile shares;
+        ShareFileReader reader(shares);
+        check(ShareScanner(documents[i], reader).scan(), "the scanner reads " + documents[i] + " itself");
+    }
+    for (const std::string& document : documents) {
+        std::string streamed = loadOutcome(document, false), in_memory = loadOutcome(document, true);
+        check(in_memory == streamed, "the scanner on " + document + ": " + in_memory + " where the parser gives " + streamed);
+    }
+}
+
+/**
+ * @brief JSON and binary share files agree on every share, after a conversion with
+ * convertFile and after toBinaryShares, for values that are negative, zero, one limb and
+ * many limbs, with and without a prime.
+ */
+void testBinaryRoundTrip(std::mt19937_64& random) {
+    std::vector<WrittenShare> written;
+    for (long long x : randomKeys(random, 300)) {
+        WrittenShare share = randomShare(random, x);
+        share.digits = std::string(random() % 8 == 0 ? 1 : 1 + random() % 200, '0');
+        for (char& digit : share.digits) digit = RADIX_DIGITS[random() % share.base];
+        if (random() % 2) share.digits.insert(share.digits.begin(), '-');
+        written.push_back(share);
+    }
+    written.push_back({"1001", 10, "0", 0});
+    written.push_back({"1002", 10, "-0", 0});
+    written.push_back({"1003", 16, "-ffffffffffffffff", 0});
+    written.push_back({"1004", 16, "10000000000000000", 0});
+    std::string text = shareFileText(written, 5, 0);
+
+    for (const char* prime : {"", "170141183460469231731687303715884105727"}) {
+        std::string document = text;
+        if (*prime != '\0') document.replace(document.find("\"k\": 5"), 6, std::string("\"k\": 5, \"prime\": \"") + prime + "\"");
+        std::string label = *prime != '\0' ? "with a prime" : "without a prime";
+
+        // through the files, as `solver convert` writes them
+        std::string directory = std::filesystem::temp_directory_path().string() + "/";
+        std::string json_name = directory + "share_file_test.json", binary_name = directory + "share_file_test.bin";
+        std::ofstream(json_name) << document;
+        std::ostringstream discarded;
+        std::streambuf* cout_buffer = std::cout.rdbuf(discarded.rdbuf());
+        int status = convertFile(json_name.c_str(), binary_name.c_str());
+        std::cout.rdbuf(cout_buffer);
+        check(status == 0, label + ": convertFile");
+        std::ifstream binary_file(binary_name, std::ios::binary);
+        std::string bytes((std::istreambuf_iterator<char>(binary_file)), std::istreambuf_iterator<char>());
+        check(bytes.compare(0, 4, "SHRB") == 0, label + ": the magic");
+        std::remove(json_name.c_str());
+        std::remove(binary_name.c_str());
+
+        for (bool all_shares : {false, true}) {
+            std::string error;
+            ShareFile from_json, from_binary;
+            std::istringstream input(document);
+            check(loadShares(input, from_json, error, all_shares), label + ": the JSON loads");
+            check(loadBinaryShares(bytes, from_binary, error, all_shares), label + ": the binary file loads: " + error);
+            check(from_binary.has_k and from_binary.k == 5 and from_binary.count == written.size()
+                      and from_binary.prime == prime and from_binary.points == from_json.points,
+                  label + (all_shares ? ": every share" : ": the 5 smallest shares"));
+        }
+
+        ShareFile shares;
+        std::string error;
+        std::istringstream input(document);
+        loadShares(input, shares, error, true);
+        ShareFile reloaded;
+        check(loadBinaryShares(toBinaryShares(shares, *prime != '\0' ? BigInt(prime) : BigInt(0)), reloaded, error, true)
+                  and reloaded.points == shares.points,
+              label + ": toBinaryShares");
+    }
+}
+
+/**
+ * @brief loadBinaryShares refuses every truncation of a file, a bad magic, an unknown
+ * version, and counts of shares or limbs that run past the data, without reading past it.
+ */
+void testBinaryRejects() {
+    ShareFile shares;
+    shares.k = 2;
+    shares.has_k = true;
+    shares.points = {{1, -5}, {2, 0}, {3, pow(BigInt(2), 130) + 7}};
+    const std::string bytes = toBinaryShares(shares, 97);
+    ShareFile loaded;
+    std::string error;
+    check(loadBinaryShares(bytes, loaded, error, true) and loaded.points == shares.points and loaded.prime == "97",
+          "the file to corrupt loads");
+
+    for (size_t size = 0; size < bytes.size(); size++) {
+        ShareFile truncated;
+        error.clear();
+        // a copy of exactly `size` bytes, so that reading past the end is an error under a sanitizer
+        std::unique_ptr<char[]> prefix(new char[size + 1]);
+        std::copy(bytes.begin(), bytes.begin() + size, prefix.get());
+        check(!loadBinaryShares(std::string_view(prefix.get(), size), truncated, error) and !error.empty(),
+              "a file truncated to " + std::to_string(size) + " bytes");
+    }
+
+    auto rejects = [&](std::string corrupted, const std::string& expected_error, const std::string& label) {
+        ShareFile corrupt;
+        std::string corrupt_error;
+        bool loaded = loadBinaryShares(corrupted, corrupt, corrupt_error);
+        check(!loaded and corrupt_error.find(expected_error) != std::string::npos, label + ": " + corrupt_error);
+    };
+    std::string corrupted = bytes;
+    corrupted[0] = 'X';
+    rejects(corrupted, "not a binary share file", "a bad magic");
+
+    corrupted = bytes;
+    corrupted[4] = 2;
+    rejects(corrupted, "unsupported version 2", "the wrong version");
+
+    for (uint64_t n : {uint64_t(4), uint64_t(1) << 40, ~uint64_t(0)}) {
+        corrupted = bytes;
+        for (int i = 0; i < 8; i++) corrupted[8 + i] = (char)(n >> (8 * i));
+        rejects(corrupted, "truncated share 3", "n = " + std::to_string(n) + " with 3 shares");
+    }
+
+    // the prime's limb count is at offset 25, after its sign byte
+    for (uint64_t count : {uint64_t(2), uint64_t(1) << 61, ~uint64_t(0)}) {
+        corrupted = bytes;
+        for (int i = 0; i < 8; i++) corrupted[25 + i] = (char)(count >> (8 * i));
+        rejects(corrupted, count == 2 ? "truncated share" : "truncated prime", "a prime of " + std::to_string(count) + " limbs");
+    }
+
+    // a k beyond the shares keeps them all, and the solver then reports too few points
+    corrupted = bytes;
+    for (int i = 0; i < 8; i++) corrupted[16 + i] = (char)0xff;
+    ShareFile all;
+    check(loadBinaryShares(corrupted, all, error) and all.k == ~size_t(0) and all.points.size() == 3, "k = 2^64 - 1");
+    std::ostringstream out, err;
+    PhaseProfile profile;
+    solveShares(all, SolverOptions(), out, err, nullptr, profile);
+    check(err.str().find("Not enough points") != std::string::npos, "k = 2^64 - 1 is reported");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 random(2024);
+    testSelection(random);
+    testDuplicateKeys(random);
+    testMissingKeysAndBadDigits(random);
+    testScannerAgainstParser();
+    testBinaryRoundTrip(random);
+    testBinaryRejects();
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All share file checks passed." << std::endl;
+    return 0;
+}
@@ -0,0 +1,61 @@
+// Helpers shared by the tests: a failure counter and random shares of integer polynomials.
+
+#ifndef TEST_UTIL_HPP
+#define TEST_UTIL_HPP
+
+#include <algorithm>
+#include <iostream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+#include "../BigInt.hpp"
+
+inline int failures = 0;
+
+inline void check(bool condition, const std::string& what) {
+    if (condition) return;
+    std::cerr << "FAILED: " << what << std::endl;
+    failures++;
+}
+
+/**
+ * @brief A random BigInt of up to `digits` decimal digits, of either sign.
+ */
+inline BigInt randomBigInt(std::mt19937_64& random, size_t digits) {
+    std::string text(1 + random() % digits, '0');
+    for (char& digit : text) digit = '0' + random() % 10;
+    if (random() % 2) text.insert(text.begin(), '-');
+    return BigInt(text);
+}
+
+/**
+ * @brief `count` distinct random keys in [-1000, 1000].
+ */
+inline std::vector<long long> randomKeys(std::mt19937_64& random, size_t count) {
+    std::vector<long long> keys;
+    while (keys.size() < count) {
+        long long x = (long long)(random() % 2001) - 1000;
+        if (std::find(keys.begin(), keys.end(), x) == keys.end()) keys.push_back(x);
+    }
+    return keys;
+}
+
+/**
+ * @brief Shares of a random integer polynomial of degree < k at the given keys.
+ */
+inline std::vector<std::pair<long long, BigInt>> randomShares(std::mt19937_64& random, size_t k,
+                                                              const std::vector<long long>& keys) {
+    std::vector<BigInt> coefficients;
+    for (size_t j = 0; j < k; j++) coefficients.push_back(randomBigInt(random, 40));
+
+    std::vector<std::pair<long long, BigInt>> shares;
+    for (long long x : keys) {
+        BigInt y = 0;
+        for (size_t j = k; j-- > 0; ) y = y * x + coefficients[j];
+        shares.push_back({x, y});
+    }
+    return shares;
+}
+
+#endif // TEST_UTIL_HPP
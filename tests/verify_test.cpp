@@ -0,0 +1,95 @@
+// Checks the share verification of --verify: findCorruptShares and confirmShares.
+//
+// Build and run from the repository root:
+//     g++ -std=c++17 -O2 -Wall -pthread -o verify_test tests/verify_test.cpp && ./verify_test
+
+#define SOLVER_NO_MAIN
+#include "../solver.cpp"
+
+#include "test_util.hpp"
+
+namespace {
+
+/**
+ * @brief Runs confirmShares, telling whether it rejected the shares.
+ */
+bool confirmRejects(const std::vector<std::pair<long long, BigInt>>& shares, const std::vector<size_t>& corrupt, size_t k) {
+    try {
+        confirmShares(shares, corrupt, k);
+    } catch (std::runtime_error&) {
+        return true;
+    }
+    return false;
+}
+
+/**
+ * @brief A share off by a multiple of 2^61 - 1 passes the modular decoder, so confirmShares
+ * must catch it, whether it is among the first k shares or after them.
+ */
+void testOffByMultipleOfPrime(std::mt19937_64& random) {
+    const size_t k = 5;
+    std::vector<long long> keys = {1, 2, 3, 4, 5, 6, 7, 8};
+    BigInt prime = (long long)Mersenne61Field::MODULUS;
+    for (size_t bad : {size_t(0), size_t(2), k, keys.size() - 1}) {
+        std::string label = "share " + std::to_string(bad) + " off by 3p";
+        std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, keys);
+        shares[bad].second += prime * 3;
+
+        std::vector<size_t> corrupt = findCorruptShares(Mersenne61Field(), shares, k);
+        check(corrupt.empty(), label + ": the decoder works modulo the prime, so it sees no error");
+        check(confirmRejects(shares, corrupt, k), label + ": confirmShares rejects it");
+    }
+
+    std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, keys);
+    check(!confirmRejects(shares, {}, k), "consistent shares are confirmed");
+}
+
+/**
+ * @brief An ordinary corrupted share is found by the decoder, and the rest are then confirmed.
+ */
+void testCorruptedShare(std::mt19937_64& random) {
+    const size_t k = 4;
+    std::vector<long long> keys = {-3, 1, 2, 5, 9, 11};
+    std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, keys);
+    shares[1].second += 1;
+
+    std::vector<size_t> corrupt = findCorruptShares(Mersenne61Field(), shares, k);
+    check(corrupt == std::vector<size_t>{1}, "the decoder finds a share off by one");
+    check(!confirmRejects(shares, corrupt, k), "the other shares are confirmed once it is excluded");
+}
+
+/**
+ * @brief Keys that meet modulo 2^61 - 1 are detected, and the shares decode modulo 2^127 - 1.
+ */
+void testCollidingKeys(std::mt19937_64& random) {
+    const size_t k = 3;
+    long long far = 1 + (long long)Mersenne61Field::MODULUS;
+    std::vector<long long> keys = {1, 2, 3, 4, far, far + 1};
+    std::vector<std::pair<long long, BigInt>> shares = randomShares(random, k, keys);
+    shares[3].second -= 5;
+
+    check(keysCollide(shares, (long long)Mersenne61Field::MODULUS), "keys 2^61 - 1 apart collide");
+    BigInt wide_prime(MERSENNE_127);
+    check(!keysCollide(shares, wide_prime), "keys 2^61 - 1 apart do not collide modulo 2^127 - 1");
+    Montgomery field(wide_prime);
+    check(findCorruptShares(MontgomeryField{field}, shares, k) == std::vector<size_t>{3},
+          "the wide field finds the corrupted share");
+}
+
+} // namespace
+
+int main() {
+    std::mt19937_64 random(2024);
+    for (int round = 0; round < 5; round++) {
+        testOffByMultipleOfPrime(random);
+        testCorruptedShare(random);
+        testCollidingKeys(random);
+    }
+
+    if (failures > 0) {
+        std::cerr << failures << " check(s) failed." << std::endl;
+        return 1;
+    }
+    std::cout << "All verification checks passed." << std::endl;
+    return 0;
+}